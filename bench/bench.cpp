@@ -0,0 +1,73 @@
+#include "bench.h"
+
+#include <dirent.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+static std::vector<BenchMetric> recorded_metrics;
+
+void bench_record(const char *suite, const std::string &name, const char *metric, double value, const char *unit) {
+    recorded_metrics.push_back(BenchMetric{suite, name, metric, value, unit});
+}
+
+const std::vector<BenchMetric> &bench_metrics() {
+    return recorded_metrics;
+}
+
+TimingStats bench_timing_stats(std::vector<uint32_t> samples) {
+    TimingStats stats = {0, 0, 0, 0};
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    stats.min_us = samples.front();
+    stats.median_us = samples[samples.size() / 2];
+    stats.p99_us = samples[std::min(samples.size() - 1, (samples.size() * 99) / 100)];
+    stats.max_us = samples.back();
+    return stats;
+}
+
+bool bench_load_file(const std::string &path, String &out) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    out = "";
+    char buffer[1024];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+        out.concat(buffer, static_cast<unsigned int>(n));
+    }
+    fclose(fp);
+    return true;
+}
+
+std::vector<std::string> bench_list_corpus(const std::string &dir, const char *prefix) {
+    std::vector<std::string> files;
+    DIR *dp = opendir(dir.c_str());
+    if (!dp) {
+        return files;
+    }
+    struct dirent *entry;
+    const size_t prefix_len = strlen(prefix);
+    while ((entry = readdir(dp)) != nullptr) {
+        std::string name = entry->d_name;
+        if (name.compare(0, prefix_len, prefix) == 0 && name.size() > 5 &&
+            name.compare(name.size() - 5, 5, ".json") == 0) {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(dp);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::string bench_payload_name(const std::string &path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    if (name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0) {
+        name.resize(name.size() - 5);
+    }
+    return name;
+}
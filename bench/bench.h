@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+// Shared plumbing for the host benchmarks: option parsing, timing
+// statistics and a flat list of recorded metrics that is printed as a table
+// and optionally written as JSON for tools/bench_gate.py.
+
+struct BenchOptions {
+    int iterations = 200;
+    std::string corpus_dir = "bench/payloads";
+    std::string json_path;
+    std::vector<std::string> suites;
+};
+
+struct BenchMetric {
+    std::string suite;
+    std::string name;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+struct TimingStats {
+    uint32_t min_us;
+    uint32_t median_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+};
+
+void bench_record(const char *suite, const std::string &name, const char *metric, double value, const char *unit);
+const std::vector<BenchMetric> &bench_metrics();
+
+TimingStats bench_timing_stats(std::vector<uint32_t> samples);
+
+bool bench_load_file(const std::string &path, String &out);
+std::vector<std::string> bench_list_corpus(const std::string &dir, const char *prefix);
+std::string bench_payload_name(const std::string &path);
+
+// Suites
+void run_parse_benchmarks(const BenchOptions &options);
+void run_transliterate_benchmarks(const BenchOptions &options);
+void run_render_benchmarks(const BenchOptions &options);
+void run_tls_benchmarks(const BenchOptions &options);
+
+#endif // BENCH_H
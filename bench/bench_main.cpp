@@ -0,0 +1,78 @@
+// Host benchmark runner.
+//   program [--iterations N] [--corpus DIR] [--json FILE] [suite ...]
+// Suites: parse (deserialize + extract/aggregate), transliterate, render (default: these three),
+// tls (full vs resumed handshakes against a local TLS server, only when named)
+
+#include "bench.h"
+
+#include <stdio.h>
+
+struct BenchSuite {
+    const char *name;
+    void (*run)(const BenchOptions &options);
+    bool by_default;            // run when no suite is named
+};
+
+static const BenchSuite SUITES[] = {
+    {"parse", run_parse_benchmarks, true},
+    {"transliterate", run_transliterate_benchmarks, true},
+    {"render", run_render_benchmarks, true},
+    {"tls", run_tls_benchmarks, false},
+};
+
+static bool write_json(const std::string &path) {
+    FILE *fp = fopen(path.c_str(), "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "{\n  \"metrics\": [\n");
+    const std::vector<BenchMetric> &metrics = bench_metrics();
+    for (size_t i = 0; i < metrics.size(); ++i) {
+        const BenchMetric &m = metrics[i];
+        fprintf(fp, "    {\"suite\": \"%s\", \"name\": \"%s\", \"metric\": \"%s\", \"value\": %.3f, \"unit\": \"%s\"}%s\n",
+                m.suite.c_str(), m.name.c_str(), m.metric.c_str(), m.value, m.unit.c_str(),
+                i + 1 < metrics.size() ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = atoi(argv[++i]);
+        } else if (arg == "--corpus" && i + 1 < argc) {
+            options.corpus_dir = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            options.json_path = argv[++i];
+        } else if (arg.compare(0, 2, "--") == 0) {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            return 2;
+        } else {
+            options.suites.push_back(arg);
+        }
+    }
+    if (options.iterations < 1) {
+        options.iterations = 1;
+    }
+
+    Serial.begin(115200);
+    for (const BenchSuite &suite : SUITES) {
+        bool selected = options.suites.empty() && suite.by_default;
+        for (const std::string &name : options.suites) {
+            selected = selected || name == suite.name;
+        }
+        if (selected) {
+            suite.run(options);
+            Serial.println();
+        }
+    }
+
+    if (!options.json_path.empty() && !write_json(options.json_path)) {
+        fprintf(stderr, "Failed to write %s\n", options.json_path.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,242 @@
+// Replays recorded /data/2.5/weather, /data/2.5/forecast and /data/3.0/onecall
+// responses through the same deserializeJson + extraction path that
+// fetch_weather, fetch_forecast and fetch_onecall use, with the same
+// filters and document sizes.
+// Bodies are framed as chunked responses and parsed through HttpBodyStream,
+// like the firmware reads them from the socket. Forecast and One Call bodies
+// are replayed a second time gzip-compressed (".gz"), through GzipStream.
+
+#include "bench.h"
+
+#include <algorithm>
+
+#include <ArduinoJson.h>
+#include <zlib.h>
+
+#include "gzip_stream.h"
+#include "http_body_stream.h"
+#include "native_heap.h"
+#include "weather_parse.h"
+
+// Chunk size of the recorded framing, as sent by tools/mock_owm_server.py
+static const size_t REPLAY_CHUNK_SIZE = 512;
+
+// Read-only Stream over a response held in memory, standing in for the socket
+class MemoryStream : public Stream {
+public:
+    MemoryStream(const String &data) : _data(data.c_str()), _size(data.length()) {}
+
+    int available() override { return static_cast<int>(_size - _pos); }
+    int read() override { return _pos < _size ? static_cast<uint8_t>(_data[_pos++]) : -1; }
+    int peek() override { return _pos < _size ? static_cast<uint8_t>(_data[_pos]) : -1; }
+    size_t readBytes(char *buffer, size_t length) override {
+        size_t n = std::min(length, _size - _pos);
+        memcpy(buffer, _data + _pos, n);
+        _pos += n;
+        return n;
+    }
+    size_t write(uint8_t) override { return 0; }
+
+private:
+    const char *_data;
+    size_t _size;
+    size_t _pos = 0;
+};
+
+static String frame_chunked(const String &body) {
+    String framed;
+    char header[16];
+    for (size_t offset = 0; offset < body.length(); offset += REPLAY_CHUNK_SIZE) {
+        size_t size = std::min(REPLAY_CHUNK_SIZE, body.length() - offset);
+        snprintf(header, sizeof(header), "%zx\r\n", size);
+        framed += header;
+        framed.concat(body.c_str() + offset, size);
+        framed += "\r\n";
+    }
+    framed += "0\r\n\r\n";
+    return framed;
+}
+
+// gzip at zlib's default level, as a server with Content-Encoding: gzip sends it
+static bool gzip_body(const String &body, String &compressed) {
+    z_stream zs = {};
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    std::vector<unsigned char> out(deflateBound(&zs, body.length()));
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(body.c_str()));
+    zs.avail_in = body.length();
+    zs.next_out = out.data();
+    zs.avail_out = out.size();
+    const int ret = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+    if (ret != Z_STREAM_END) {
+        return false;
+    }
+    compressed = String();
+    compressed.concat(reinterpret_cast<const char *>(out.data()), zs.total_out);
+    return true;
+}
+
+enum PayloadKind {
+    PAYLOAD_WEATHER,
+    PAYLOAD_FORECAST,
+    PAYLOAD_ONECALL
+};
+
+static size_t payload_capacity(PayloadKind kind) {
+    switch (kind) {
+        case PAYLOAD_WEATHER: return WEATHER_JSON_CAPACITY;
+        case PAYLOAD_FORECAST: return FORECAST_JSON_CAPACITY;
+        default: return ONECALL_JSON_CAPACITY;
+    }
+}
+
+static const JsonDocument &payload_filter(PayloadKind kind) {
+    switch (kind) {
+        case PAYLOAD_WEATHER: return current_weather_filter();
+        case PAYLOAD_FORECAST: return forecast_filter();
+        default: return onecall_filter();
+    }
+}
+
+// One pass of the fetch path on a chunked response: deserialize from the
+// body stream (inflated on the way when gzip), read to the end of the body,
+// then extract/aggregate.
+static bool replay_payload(PayloadKind kind, const String &framed, bool gzip, uint32_t &parse_us,
+                           uint32_t &extract_us, size_t &doc_used, size_t &doc_capacity, DeserializationError &error) {
+    MemoryStream socket(framed);
+    HttpBodyStream body(socket, true, -1);
+    GzipStream inflated(body);
+    DynamicJsonDocument doc(payload_capacity(kind));
+    DeserializationOption::Filter filter(payload_filter(kind));
+
+    unsigned long start = micros();
+    if (gzip) {
+        error = deserializeJson(doc, inflated, filter);
+        if (!inflated.finish() && !error) {
+            error = DeserializationError::InvalidInput;
+        }
+    } else {
+        error = deserializeJson(doc, body, filter);
+    }
+    if (!body.finish() && !error) {
+        error = DeserializationError::IncompleteInput;
+    }
+    parse_us = static_cast<uint32_t>(micros() - start);
+    doc_used = doc.memoryUsage();
+    doc_capacity = doc.capacity();
+    if (error) {
+        extract_us = 0;
+        return false;
+    }
+
+    start = micros();
+    if (kind == PAYLOAD_WEATHER) {
+        WeatherData weather;
+        parse_current_weather(doc, weather);
+    } else if (kind == PAYLOAD_ONECALL) {
+        WeatherData weather = {};
+        ForecastEntry entries[FORECAST_DAYS];
+        parse_onecall_current(doc, weather);
+        parse_onecall_daily(doc, doc["current"]["dt"] | 0L, entries, FORECAST_DAYS);
+    } else {
+        // Aggregate as of the first slot so the result does not depend on today's date
+        ForecastEntry entries[FORECAST_DAYS];
+        time_t captured_at = doc["list"][0]["dt"] | 0L;
+        aggregate_forecast(doc, captured_at, entries, FORECAST_DAYS);
+    }
+    extract_us = static_cast<uint32_t>(micros() - start);
+    return true;
+}
+
+static void run_payload(PayloadKind kind, const std::string &path, int iterations, bool gzip = false) {
+    String recorded;
+    if (!bench_load_file(path, recorded)) {
+        Serial.printf("  %s: cannot read file\n", path.c_str());
+        return;
+    }
+    const std::string name = bench_payload_name(path) + (gzip ? ".gz" : "");
+    String body = recorded;
+    if (gzip && !gzip_body(recorded, body)) {
+        Serial.printf("  %s: gzip failed\n", name.c_str());
+        return;
+    }
+    const String framed = frame_chunked(body);
+
+    uint32_t parse_us = 0;
+    uint32_t extract_us = 0;
+    size_t doc_used = 0;
+    size_t doc_capacity = 0;
+    DeserializationError error;
+
+    // Peak heap of a single pass, measured on a cold run
+    NativeHeapStats before = native_heap_stats();
+    native_heap_reset_peak();
+    replay_payload(kind, framed, gzip, parse_us, extract_us, doc_used, doc_capacity, error);
+    size_t peak_heap = native_heap_stats().peak - before.in_use;
+
+    if (error) {
+        Serial.printf("  %-32s %6u B  deserializeJson failed: %s\n", name.c_str(), body.length(), error.c_str());
+        bench_record("parse", name, "errors", 1, "count");
+        return;
+    }
+
+    std::vector<uint32_t> parse_samples;
+    std::vector<uint32_t> extract_samples;
+    parse_samples.reserve(iterations);
+    extract_samples.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        replay_payload(kind, framed, gzip, parse_us, extract_us, doc_used, doc_capacity, error);
+        parse_samples.push_back(parse_us);
+        extract_samples.push_back(extract_us);
+    }
+
+    TimingStats parse_stats = bench_timing_stats(parse_samples);
+    TimingStats extract_stats = bench_timing_stats(extract_samples);
+    double fill = doc_capacity ? 100.0 * doc_used / doc_capacity : 0.0;
+
+    Serial.printf("  %-32s %6u B  parse %6u us (min %6u, p99 %6u)  %s %5u us  doc %6zu/%6zu B (%5.1f%%)  peak heap %7zu B\n",
+                  name.c_str(), body.length(), parse_stats.median_us, parse_stats.min_us, parse_stats.p99_us,
+                  kind == PAYLOAD_WEATHER ? "extract" : "aggregate", extract_stats.median_us, doc_used, doc_capacity,
+                  fill, peak_heap);
+
+    bench_record("parse", name, "payload_bytes", body.length(), "B");
+    bench_record("parse", name, "parse_us", parse_stats.median_us, "us");
+    bench_record("parse", name, "parse_p99_us", parse_stats.p99_us, "us");
+    bench_record("parse", name, kind == PAYLOAD_WEATHER ? "extract_us" : "aggregate_us", extract_stats.median_us, "us");
+    bench_record("parse", name, "doc_used_bytes", doc_used, "B");
+    bench_record("parse", name, "doc_fill_pct", fill, "%");
+    bench_record("parse", name, "peak_heap_bytes", peak_heap, "B");
+}
+
+void run_parse_benchmarks(const BenchOptions &options) {
+    Serial.printf("Parse benchmark (%d iterations per payload, corpus %s)\n", options.iterations,
+                  options.corpus_dir.c_str());
+    Serial.printf("  JSON_CAPACITY_SCALE=%d: document sizes are %dx the ESP32 values\n", JSON_CAPACITY_SCALE,
+                  JSON_CAPACITY_SCALE);
+
+    std::vector<std::string> weather_files = bench_list_corpus(options.corpus_dir, "weather_");
+    std::vector<std::string> forecast_files = bench_list_corpus(options.corpus_dir, "forecast_");
+    std::vector<std::string> onecall_files = bench_list_corpus(options.corpus_dir, "onecall_");
+    if (weather_files.empty() && forecast_files.empty() && onecall_files.empty()) {
+        Serial.println("  No payloads found");
+        return;
+    }
+
+    for (const std::string &path : weather_files) {
+        run_payload(PAYLOAD_WEATHER, path, options.iterations);
+    }
+    for (const std::string &path : forecast_files) {
+        run_payload(PAYLOAD_FORECAST, path, options.iterations);
+    }
+    for (const std::string &path : onecall_files) {
+        run_payload(PAYLOAD_ONECALL, path, options.iterations);
+    }
+    for (const std::string &path : forecast_files) {
+        run_payload(PAYLOAD_FORECAST, path, options.iterations, true);
+    }
+    for (const std::string &path : onecall_files) {
+        run_payload(PAYLOAD_ONECALL, path, options.iterations, true);
+    }
+}
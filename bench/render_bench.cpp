@@ -0,0 +1,141 @@
+// Builds the firmware's weather screen (create_ui) on the headless display
+// and measures what a refresh costs LVGL: the time update_ui and
+// update_forecast_ui take to change the widgets, then the time, flushed
+// areas and pixels of the frame that redraws them. Alternates between the
+// recorded payloads so every refresh changes the text and icons.
+
+#include "bench.h"
+
+#include <ArduinoJson.h>
+#include <lvgl.h>
+
+#include "headless_display.h"
+#include "weather_parse.h"
+#include "weather_ui.h"
+
+struct RenderInput {
+    WeatherData weather;
+    ForecastEntry forecast[FORECAST_DAYS];
+};
+
+static lv_disp_draw_buf_t draw_buf;
+// Same partial buffer as lvgl_init() in main.cpp
+static lv_color_t buf[240 * 10];
+static bool lvgl_ready = false;
+
+static void init_headless_lvgl() {
+    if (lvgl_ready) {
+        return;
+    }
+    lv_init();
+    lv_disp_draw_buf_init(&draw_buf, buf, NULL, 240 * 10);
+    static lv_disp_drv_t disp_drv;
+    lv_disp_drv_init(&disp_drv);
+    headless_display_init(&disp_drv);
+    disp_drv.draw_buf = &draw_buf;
+    headless_display_attach(lv_disp_drv_register(&disp_drv));
+    lvgl_ready = true;
+}
+
+static std::vector<RenderInput> load_inputs(const std::string &corpus_dir) {
+    std::vector<std::string> weather_files = bench_list_corpus(corpus_dir, "weather_");
+    std::vector<std::string> forecast_files = bench_list_corpus(corpus_dir, "forecast_");
+    std::vector<RenderInput> inputs;
+    for (size_t i = 0; i < weather_files.size(); ++i) {
+        RenderInput input;
+        reset_forecast_entries(input.forecast, FORECAST_DAYS);
+
+        String payload;
+        DynamicJsonDocument weather_doc(WEATHER_JSON_CAPACITY);
+        if (!bench_load_file(weather_files[i], payload) || deserializeJson(weather_doc, payload, DeserializationOption::Filter(current_weather_filter()))) {
+            continue;
+        }
+        parse_current_weather(weather_doc, input.weather);
+
+        if (!forecast_files.empty()) {
+            DynamicJsonDocument forecast_doc(FORECAST_JSON_CAPACITY);
+            const std::string &forecast_path = forecast_files[i % forecast_files.size()];
+            if (bench_load_file(forecast_path, payload) &&
+                !deserializeJson(forecast_doc, payload, DeserializationOption::Filter(forecast_filter()))) {
+                time_t captured_at = forecast_doc["list"][0]["dt"] | 0L;
+                aggregate_forecast(forecast_doc, captured_at, input.forecast, FORECAST_DAYS);
+            }
+        }
+        inputs.push_back(input);
+    }
+    return inputs;
+}
+
+void run_render_benchmarks(const BenchOptions &options) {
+    Serial.printf("Render benchmark (%d refreshes, headless %dx%d)\n", options.iterations, HEADLESS_DISPLAY_WIDTH,
+                  HEADLESS_DISPLAY_HEIGHT);
+
+    std::vector<RenderInput> inputs = load_inputs(options.corpus_dir);
+    if (inputs.empty()) {
+        Serial.println("  No payloads found");
+        return;
+    }
+
+    init_headless_lvgl();
+    lv_obj_clean(lv_scr_act());
+    headless_display_reset_stats();
+
+    unsigned long start = micros();
+    create_ui();
+    uint32_t create_us = static_cast<uint32_t>(micros() - start);
+    const HeadlessFrameStats *frame = headless_display_refresh_now();
+    uint32_t first_frame_us = frame ? frame->render_us : 0;
+
+    std::vector<uint32_t> update_samples;
+    std::vector<uint32_t> render_samples;
+    std::vector<uint32_t> area_samples;
+    std::vector<uint32_t> pixel_samples;
+    for (int i = 0; i < options.iterations; ++i) {
+        const RenderInput &input = inputs[i % inputs.size()];
+        start = micros();
+        update_ui(input.weather);
+        update_forecast_ui(input.forecast);
+        update_samples.push_back(static_cast<uint32_t>(micros() - start));
+
+        frame = headless_display_refresh_now();
+        render_samples.push_back(frame ? frame->render_us : 0);
+        area_samples.push_back(frame ? frame->areas : 0);
+        pixel_samples.push_back(frame ? frame->pixels : 0);
+    }
+
+    // Whole screen, as after a wake-up or a theme change
+    std::vector<uint32_t> full_samples;
+    for (int i = 0; i < options.iterations; ++i) {
+        lv_obj_invalidate(lv_scr_act());
+        frame = headless_display_refresh_now();
+        full_samples.push_back(frame ? frame->render_us : 0);
+    }
+
+    TimingStats update_stats = bench_timing_stats(update_samples);
+    TimingStats render_stats = bench_timing_stats(render_samples);
+    TimingStats full_stats = bench_timing_stats(full_samples);
+    uint32_t areas = bench_timing_stats(area_samples).median_us;
+    uint32_t pixels = bench_timing_stats(pixel_samples).median_us;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    Serial.printf("  create_ui %6u us, first frame %6u us\n", create_us, first_frame_us);
+    Serial.printf("  refresh: update %5u us (p99 %5u)  render %6u us (p99 %6u)  %u areas  %u px\n",
+                  update_stats.median_us, update_stats.p99_us, render_stats.median_us, render_stats.p99_us, areas,
+                  pixels);
+    Serial.printf("  full screen: %6u us (p99 %6u)\n", full_stats.median_us, full_stats.p99_us);
+    Serial.printf("  lv_mem: %u B used, peak %u B of %u B, frag %u%%\n", mon.total_size - mon.free_size,
+                  mon.max_used, mon.total_size, mon.frag_pct);
+
+    bench_record("render", "create_ui", "time_us", create_us, "us");
+    bench_record("render", "create_ui", "first_frame_us", first_frame_us, "us");
+    bench_record("render", "refresh", "update_us", update_stats.median_us, "us");
+    bench_record("render", "refresh", "render_us", render_stats.median_us, "us");
+    bench_record("render", "refresh", "render_p99_us", render_stats.p99_us, "us");
+    bench_record("render", "refresh", "areas", areas, "count");
+    bench_record("render", "refresh", "pixels", pixels, "px");
+    bench_record("render", "full_screen", "render_us", full_stats.median_us, "us");
+    bench_record("render", "lv_mem", "used_bytes", mon.total_size - mon.free_size, "B");
+    bench_record("render", "lv_mem", "peak_bytes", mon.max_used, "B");
+}
@@ -0,0 +1,83 @@
+// Connects to a local TLS server (tools/mock_owm_server.py --tls-cert ...)
+// and measures TCP connect + handshake with TlsClient: full handshakes, with
+// the saved session dropped before every connection, against resumed ones,
+// which offer the session of the previous connection. The server is taken
+// from WS_TLS_BENCH_HOST (host:port, default 127.0.0.1:8443); the suite is
+// skipped when nothing answers there.
+
+#include "bench.h"
+
+#include "tls_client.h"
+
+static const int MAX_HANDSHAKES = 100;
+
+static bool parse_target(String &host, uint16_t &port) {
+    const char *target = getenv("WS_TLS_BENCH_HOST");
+    String value = target && *target ? target : "127.0.0.1:8443";
+    int colon = value.indexOf(':');
+    host = colon >= 0 ? value.substring(0, colon) : value;
+    port = colon >= 0 ? static_cast<uint16_t>(value.substring(colon + 1).toInt()) : 443;
+    return host.length() > 0 && port != 0;
+}
+
+static bool run_handshakes(TlsClient &client, const String &host, uint16_t port, bool resume, int count,
+                           std::vector<uint32_t> &samples, int &resumed) {
+    resumed = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!resume) {
+            client.forgetSession();
+        }
+        const uint32_t started = micros();
+        if (!client.connect(host.c_str(), port)) {
+            return false;
+        }
+        samples.push_back(micros() - started);
+        resumed += client.lastHandshakeResumed() ? 1 : 0;
+        client.stop();
+    }
+    return true;
+}
+
+static void report(const char *name, const std::vector<uint32_t> &samples, int resumed) {
+    TimingStats stats = bench_timing_stats(samples);
+    Serial.printf("  %-10s %4zu handshakes  median %6u us (min %6u, p99 %6u)  resumed %3d\n", name, samples.size(),
+                  stats.median_us, stats.min_us, stats.p99_us, resumed);
+    bench_record("tls", name, "handshake_us", stats.median_us, "us");
+    bench_record("tls", name, "handshake_p99_us", stats.p99_us, "us");
+    bench_record("tls", name, "resumed", resumed, "count");
+}
+
+void run_tls_benchmarks(const BenchOptions &options) {
+    String host;
+    uint16_t port = 0;
+    if (!parse_target(host, port)) {
+        Serial.println("TLS benchmark: bad WS_TLS_BENCH_HOST");
+        return;
+    }
+    const int count = std::min(options.iterations, MAX_HANDSHAKES);
+    Serial.printf("TLS handshake benchmark (%d connections each, server %s:%u)\n", count, host.c_str(), port);
+
+    TlsClient client;
+    client.setSecure(true);
+    // The mock's certificate is self-signed; the handshake cost is the same
+    client.setInsecure();
+    client.setServerName("localhost");
+    // Prime the session cache; also tells whether the server is there at all
+    if (!client.connect(host.c_str(), port)) {
+        Serial.println("  no TLS server answering, skipped (see tools/mock_owm_server.py --tls-cert)");
+        return;
+    }
+    client.stop();
+
+    std::vector<uint32_t> full;
+    std::vector<uint32_t> resumed;
+    int full_resumed = 0;
+    int resumed_count = 0;
+    if (!run_handshakes(client, host, port, false, count, full, full_resumed) ||
+        !run_handshakes(client, host, port, true, count, resumed, resumed_count)) {
+        Serial.println("  connection failed during the benchmark");
+        return;
+    }
+    report("full", full, full_resumed);
+    report("resumed", resumed, resumed_count);
+}
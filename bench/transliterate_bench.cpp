@@ -0,0 +1,76 @@
+// Times transliterate_to_ascii, which update_ui runs on the city name and the
+// weather description every refresh, and counts the heap allocations each
+// call makes (String::replace with literal arguments builds temporaries).
+
+#include "bench.h"
+
+#include <ArduinoJson.h>
+
+#include "native_heap.h"
+#include "weather_parse.h"
+#include "weather_ui.h"
+
+struct TransliterateInput {
+    std::string name;
+    String text;
+};
+
+// Names and descriptions with the characters the table handles, plus plain ASCII
+static const char *const FIXED_INPUTS[][2] = {
+    {"ascii_city", "Belgrade"},
+    {"serbian_city", "Niš"},
+    {"serbian_long", "Čačak, Šabac, Užice, Đakovica"},
+    {"german_city", "Zürich"},
+    {"french_desc", "légère pluie à Besançon"},
+    {"spanish_city", "A Coruña"},
+};
+
+static void add_corpus_inputs(const std::string &corpus_dir, std::vector<TransliterateInput> &inputs) {
+    for (const std::string &path : bench_list_corpus(corpus_dir, "weather_")) {
+        String payload;
+        if (!bench_load_file(path, payload)) {
+            continue;
+        }
+        DynamicJsonDocument doc(WEATHER_JSON_CAPACITY);
+        if (deserializeJson(doc, payload, DeserializationOption::Filter(current_weather_filter()))) {
+            continue;
+        }
+        WeatherData weather;
+        parse_current_weather(doc, weather);
+        const std::string name = bench_payload_name(path);
+        inputs.push_back({name + "_city", weather.city});
+        inputs.push_back({name + "_desc", weather.description});
+    }
+}
+
+void run_transliterate_benchmarks(const BenchOptions &options) {
+    Serial.printf("Transliterate benchmark (%d iterations per input)\n", options.iterations);
+
+    std::vector<TransliterateInput> inputs;
+    for (const auto &fixed : FIXED_INPUTS) {
+        inputs.push_back({fixed[0], String(fixed[1])});
+    }
+    add_corpus_inputs(options.corpus_dir, inputs);
+
+    for (const TransliterateInput &input : inputs) {
+        // Allocations of a single call, including the by-value argument copy
+        NativeHeapStats before = native_heap_stats();
+        String result = transliterate_to_ascii(input.text);
+        uint32_t allocations = native_heap_stats().allocations - before.allocations;
+
+        std::vector<uint32_t> samples;
+        samples.reserve(options.iterations);
+        for (int i = 0; i < options.iterations; ++i) {
+            unsigned long start = micros();
+            String out = transliterate_to_ascii(input.text);
+            samples.push_back(static_cast<uint32_t>(micros() - start));
+        }
+        TimingStats stats = bench_timing_stats(samples);
+
+        Serial.printf("  %-32s %3u B  %5u us (p99 %5u)  %3u allocs  -> %s\n", input.name.c_str(),
+                      input.text.length(), stats.median_us, stats.p99_us, allocations, result.c_str());
+
+        bench_record("transliterate", input.name, "call_us", stats.median_us, "us");
+        bench_record("transliterate", input.name, "allocations", allocations, "count");
+    }
+}
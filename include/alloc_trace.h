@@ -0,0 +1,66 @@
+#ifndef ALLOC_TRACE_H
+#define ALLOC_TRACE_H
+
+#include <Arduino.h>
+
+// Allocation tracing for debug builds (-D ALLOC_TRACE=1 together with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free). Every heap
+// allocation and free made by the loop and network tasks is counted;
+// ALLOC_TRACE_SCOPE attributes the counts inside a scope to a phase of the
+// task that opened it. Phases nest, so counts are inclusive: update_ui
+// includes transliterate_to_ascii. Without ALLOC_TRACE the macros compile to
+// nothing.
+
+#ifndef ALLOC_TRACE
+#define ALLOC_TRACE 0
+#endif
+
+enum AllocPhase {
+    ALLOC_PHASE_LOOP,
+    ALLOC_PHASE_TRANSLITERATE,
+    ALLOC_PHASE_UPDATE_UI,
+    ALLOC_PHASE_FETCH_WEATHER,
+    ALLOC_PHASE_FETCH_FORECAST,
+    ALLOC_PHASE_SD_CONFIG_LOAD,
+    ALLOC_PHASE_COUNT
+};
+
+struct AllocCounts {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t bytes_allocated;
+    uint32_t bytes_freed;
+};
+
+#if ALLOC_TRACE
+
+// Called by the allocator wrappers with the usable size of the block
+void alloc_trace_note_alloc(size_t size);
+void alloc_trace_note_free(size_t size);
+
+AllocCounts alloc_trace_totals();
+void alloc_trace_record(AllocPhase phase, const AllocCounts &before);
+void alloc_trace_print(Print &out);
+void alloc_trace_reset();
+
+class AllocTraceScope {
+public:
+    explicit AllocTraceScope(AllocPhase phase) : _phase(phase), _before(alloc_trace_totals()) {}
+    ~AllocTraceScope() { alloc_trace_record(_phase, _before); }
+
+private:
+    AllocPhase _phase;
+    AllocCounts _before;
+};
+
+#define ALLOC_TRACE_CONCAT_(a, b) a##b
+#define ALLOC_TRACE_CONCAT(a, b) ALLOC_TRACE_CONCAT_(a, b)
+#define ALLOC_TRACE_SCOPE(phase) AllocTraceScope ALLOC_TRACE_CONCAT(alloc_trace_scope_, __LINE__)(phase)
+
+#else
+
+#define ALLOC_TRACE_SCOPE(phase) do { } while (0)
+
+#endif
+
+#endif
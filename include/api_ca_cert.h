@@ -0,0 +1,11 @@
+#ifndef API_CA_CERT_H
+#define API_CA_CERT_H
+
+// Root certificates built into the firmware for verifying the API server
+// when no CA file is on the SD card (PEM, several concatenated). They cover
+// the Sectigo chain api.openweathermap.org is issued under, Sectigo's newer
+// R46 root and Let's Encrypt. A server signed by another CA needs its root
+// in weather_api_ca_file.
+extern const char API_CA_PEM[];
+
+#endif
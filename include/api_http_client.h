@@ -0,0 +1,27 @@
+#ifndef API_HTTP_CLIENT_H
+#define API_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+// HTTPClient for the API requests. The library writes a fixed
+// "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0" line into every HTTP/1.1
+// request, which rules gzip out, and a header added with addHeader() only
+// comes as a second line next to it. GET() here writes the request itself
+// with a single Accept-Encoding line and otherwise the same header block;
+// connecting and reading the response are left to HTTPClient. Relies on the
+// protected members of the arduino-esp32 HTTPClient (platform pinned in
+// platformio.ini). Authorization and redirects are not supported; the API
+// uses neither.
+
+#define API_ACCEPT_ENCODING "gzip"
+
+class ApiHttpClient : public HTTPClient {
+public:
+    int GET();
+
+private:
+    bool sendRequestHeader(const char *type);
+};
+
+#endif
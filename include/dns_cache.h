@@ -0,0 +1,29 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Address of the API host, kept for the TTL of the DNS answer so reconnects
+// skip the lookup. The A record is queried directly from the DHCP-provided
+// nameserver, since the system resolver does not report the TTL; if that
+// fails, WiFi.hostByName() is used with DNS_CACHE_DEFAULT_TTL_S.
+// An expired address is still handed out; dns_cache_refresh() renews it
+// between refreshes, so a lookup is only waited for on the first request and
+// after the cached address stopped accepting connections.
+// Not thread-safe: only used by the network task.
+
+#define DNS_CACHE_TIMEOUT_MS 2000
+#define DNS_CACHE_DEFAULT_TTL_S 300
+#define DNS_CACHE_MIN_TTL_S 60
+#define DNS_CACHE_MAX_TTL_S 86400
+
+// Address for host, resolving it if nothing is cached. IP literals are
+// returned as they are.
+bool dns_cache_resolve(const char *host, IPAddress &address);
+// Forgets the cached address, e.g. after it refused a connection
+void dns_cache_invalidate();
+// Resolves the cached host again if its TTL has run out
+void dns_cache_refresh();
+
+#endif
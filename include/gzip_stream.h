@@ -0,0 +1,49 @@
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <Arduino.h>
+
+// Inflates a gzip body (Content-Encoding: gzip) while it is read, so JSON can
+// be deserialized from a compressed response without first decompressing it
+// into a buffer of its own. What is kept is the deflate window, the last
+// GZIP_WINDOW_SIZE inflated bytes (32 KB, the furthest a back-reference can
+// reach), so a body shorter than that does sit in the window whole. The
+// window and the decoder state (~1.7 KB) are static and allocated once, so
+// only one stream can inflate at a time. The CRC-32 and length in the gzip
+// trailer are checked by finish().
+
+#define GZIP_WINDOW_SIZE 32768
+
+class GzipStream : public Stream {
+public:
+    explicit GzipStream(Stream &source);
+    ~GzipStream() override;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+
+    // Inflates and discards what is left, then checks the trailer. False when
+    // the data was corrupt or cut short, or another stream was inflating.
+    bool finish();
+    size_t bytes_out() const { return _out_total; }
+    const char *error() const { return _error; }
+
+private:
+    struct Inflater;
+
+    bool fill();
+    void fail(const char *error);
+    void put(uint8_t c);
+
+    Stream &_source;
+    Inflater *_inflater = nullptr;  // the shared decoder state, once reading started
+    size_t _out_total = 0;  // bytes inflated so far
+    size_t _read_total = 0; // bytes handed to the reader so far
+    bool _ended = false;    // trailer read and checked
+    const char *_error = nullptr;
+};
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef HTTP_BODY_STREAM_H
+#define HTTP_BODY_STREAM_H
+
+#include <Arduino.h>
+
+// Body of an HTTP response read straight from the connection, so JSON can be
+// deserialized from the socket without buffering the whole payload in a
+// String. Chunked transfer framing is removed and reading stops at the end
+// of the body (Content-Length or the last chunk), which leaves a keep-alive
+// connection at the start of the next response.
+
+#define HTTP_BODY_BUFFER_SIZE 128
+
+class HttpBodyStream : public Stream {
+public:
+    // content_length < 0 without chunking reads until the connection closes
+    HttpBodyStream(Stream &source, bool chunked, int content_length);
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t readBytes(char *buffer, size_t length) override;
+    size_t write(uint8_t) override { return 0; }
+
+    // Reads and discards what is left of the body. False when the body was
+    // cut short or badly framed; the connection should not be reused then.
+    bool finish();
+    size_t bytes_read() const { return _bytes_read; }
+
+private:
+    bool fill();
+    bool read_source(char &c);
+    bool read_chunk_size();
+
+    Stream &_source;
+    bool _chunked;
+    long _remaining;        // bytes left in the chunk or body, -1 when unknown
+    bool _first_chunk = true;
+    bool _done = false;
+    bool _failed = false;
+    size_t _bytes_read = 0;
+    char _buffer[HTTP_BODY_BUFFER_SIZE];
+    size_t _pos = 0;
+    size_t _len = 0;
+};
+
+#endif
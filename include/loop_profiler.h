@@ -0,0 +1,54 @@
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+
+// Per-stage timing of loop(). Each stage keeps its last PROFILER_RING_SIZE
+// durations in a ring buffer; summaries (min/avg/p99 over the ring, plus the
+// worst sample since the last reset) are printed on demand over Serial.
+// Stages may be recorded from any task; the rings are only touched inside a
+// critical section.
+
+#define PROFILER_RING_SIZE 64
+
+enum ProfileStage {
+    STAGE_LOOP,
+    STAGE_LV_TIMER,
+    STAGE_TIME_DISPLAY,
+    STAGE_FETCH_WEATHER,
+    STAGE_FETCH_FORECAST,
+    STAGE_DESERIALIZE,
+    STAGE_UPDATE_UI,
+    STAGE_DISP_FLUSH,
+    STAGE_COUNT
+};
+
+struct ProfileSummary {
+    uint32_t count;      // samples recorded since reset
+    uint32_t window;     // samples currently in the ring
+    uint32_t last_us;
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t p99_us;
+    uint32_t max_us;     // worst sample since reset
+};
+
+void profiler_record(ProfileStage stage, uint32_t duration_us);
+bool profiler_summary(ProfileStage stage, ProfileSummary &summary);
+uint32_t profiler_last_us(ProfileStage stage);
+const char *profiler_stage_name(ProfileStage stage);
+void profiler_print(Print &out);
+void profiler_reset();
+
+// Records the lifetime of the scope as one sample of the given stage
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : _stage(stage), _start(micros()) {}
+    ~ProfileScope() { profiler_record(_stage, static_cast<uint32_t>(micros() - _start)); }
+
+private:
+    ProfileStage _stage;
+    unsigned long _start;
+};
+
+#endif
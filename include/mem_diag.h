@@ -0,0 +1,46 @@
+#ifndef MEM_DIAG_H
+#define MEM_DIAG_H
+
+#include <Arduino.h>
+
+// Heap and stack watermarks around each weather refresh. A snapshot of the
+// system heap (free, largest free block, lowest free since boot), the LVGL
+// pool (lv_mem_monitor against LV_MEM_SIZE) and the calling task's stack
+// high-water mark is taken after every phase of a refresh (response headers
+// received, body parsed), so the cost of the JsonDocument shows up per
+// phase. A one-line summary per phase is printed when the refresh ends.
+// Phases may be marked from the network task: LVGL is only queried on the
+// task that called mem_diag_begin_refresh(), and the stack column then
+// belongs to the network task.
+
+enum MemPhase {
+    MEM_PHASE_START,
+    MEM_PHASE_WEATHER_RESPONSE,
+    MEM_PHASE_WEATHER_PARSED,
+    MEM_PHASE_FORECAST_RESPONSE,
+    MEM_PHASE_FORECAST_PARSED,
+    MEM_PHASE_RENDERED,
+    MEM_PHASE_COUNT
+};
+
+struct MemSnapshot {
+    uint32_t free_heap;
+    uint32_t largest_block;
+    uint32_t min_free_heap;
+    uint32_t lv_used;           // bytes of the LV_MEM_SIZE pool in use
+    uint32_t lv_max_used;
+    uint32_t lv_free_biggest;
+    uint8_t lv_frag_pct;
+    uint32_t stack_free;        // stack of the marking task never used, bytes
+};
+
+void mem_diag_snapshot(MemSnapshot &snapshot);
+void mem_diag_begin_refresh();
+void mem_diag_mark(MemPhase phase);
+// Prints the phases marked since mem_diag_begin_refresh()
+void mem_diag_end_refresh(Print &out);
+// Current state plus the worst values seen over all refreshes
+void mem_diag_print(Print &out);
+const char *mem_diag_phase_name(MemPhase phase);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <lvgl.h>
+
+// On-screen diagnostics for units without a serial console: FPS, CPU load,
+// display flush time, LVGL memory use and the last fetch latencies, drawn on
+// the top layer and refreshed twice a second while visible. Built in at all
+// times (unlike LV_USE_PERF_MONITOR) and toggled at runtime.
+
+#define PERF_OVERLAY_PERIOD_MS 500
+
+// Display driver monitor_cb: counts rendered frames and render time
+void perf_overlay_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px);
+void perf_overlay_create();
+void perf_overlay_toggle();
+bool perf_overlay_visible();
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Decides when the next weather refresh is due and whether it includes the
+// forecast, which has its own, longer interval (OpenWeatherMap recomputes it
+// every 3 hours). After a successful refresh the configured interval applies,
+// shortened while the weather is changing fast. Failed refreshes are retried
+// with exponential backoff. All delays get +-10% jitter. The API calls of the
+// current UTC day (the day OpenWeatherMap counts by) are tracked against a
+// daily limit, and the interval is stretched so the remaining calls last
+// until midnight.
+
+#define REFRESH_RETRY_MIN_MS 30000              // first retry after a failure
+#define REFRESH_BACKOFF_MAX_MS 3600000          // API errors back off up to 1 hour
+#define REFRESH_FAST_INTERVAL_MS 600000         // current data is updated every ~10 minutes
+#define REFRESH_JITTER_PERCENT 10
+
+enum RefreshOutcome : uint8_t {
+    REFRESH_OK,
+    REFRESH_NETWORK_ERROR,      // no WiFi, no connection: costs no API calls
+    REFRESH_API_ERROR,          // HTTP error status or a body that did not parse
+};
+
+enum ScheduleReason : uint8_t {
+    SCHEDULE_START,
+    SCHEDULE_NORMAL,
+    SCHEDULE_FAST,              // weather changing fast
+    SCHEDULE_RETRY,             // backing off after failures
+    SCHEDULE_BUDGET,            // stretched to stay within the daily limit
+    SCHEDULE_QUOTA_EXHAUSTED,   // waiting for the next UTC day
+    SCHEDULE_LINK_UP,           // WiFi came back after network failures
+};
+
+// base_interval_ms: interval between successful refreshes; forecast_interval_ms:
+// interval between forecast updates; daily_call_limit: API calls per UTC day,
+// 0 for no limit
+void refresh_scheduler_begin(uint32_t base_interval_ms, uint32_t forecast_interval_ms, uint32_t daily_call_limit);
+bool refresh_scheduler_due(uint32_t now_ms);
+// Whether the refresh that is due should also update the forecast
+bool refresh_scheduler_forecast_due(uint32_t now_ms);
+// Records a finished refresh and schedules the next one. api_calls is the
+// number of requests the server answered, forecast_updated whether a new
+// forecast arrived, changing_fast whether the new observation differs a lot
+// from the previous one.
+void refresh_scheduler_finished(uint32_t now_ms, time_t now_utc, RefreshOutcome outcome, uint8_t api_calls,
+                                bool forecast_updated, bool changing_fast);
+// The WiFi link came (back) up: a refresh retrying after network failures is
+// due right away instead of at the end of its backoff
+void refresh_scheduler_link_up(uint32_t now_ms);
+uint32_t refresh_scheduler_next_delay_ms();
+ScheduleReason refresh_scheduler_reason();
+const char *refresh_scheduler_reason_name(ScheduleReason reason);
+void refresh_scheduler_print(Print &out, uint32_t now_ms);
+
+#endif
@@ -5,21 +5,79 @@
 #include "FS.h"
 #include "SD.h"
 #include "config.h"
+#include "alloc_trace.h"
+
+#ifndef WEATHER_API_HOST
+#define WEATHER_API_HOST "api.openweathermap.org"
+#endif
+
+// "auto" tries One Call and falls back to the two 2.5 requests, "onecall"
+// and "split" use only one of them (onecall needs weather_lat/weather_lon)
+#ifndef WEATHER_API_MODE
+#define WEATHER_API_MODE "auto"
+#endif
+
+// HTTPS for the API requests. The server is verified with the CA certificate
+// in WEATHER_API_CA_FILE on the SD card when it is there, otherwise with the
+// roots built into the firmware (src/api_ca_cert.cpp)
+#ifndef WEATHER_API_HTTPS
+#define WEATHER_API_HTTPS 1
+#endif
+
+#ifndef WEATHER_API_CA_FILE
+#define WEATHER_API_CA_FILE "/api_ca.pem"
+#endif
+
+// Skip verifying the server: the API key is readable by anyone on the path.
+// Only for test servers with a certificate no CA signed.
+#ifndef WEATHER_API_INSECURE
+#define WEATHER_API_INSECURE 0
+#endif
+
+// Reconnect with the address of the last DHCP lease (kept in NVS) instead of
+// asking for one. Saves the DHCP exchange on boot; only safe when the router
+// reserves that address for the station.
+#ifndef WIFI_REUSE_IP
+#define WIFI_REUSE_IP 0
+#endif
+
+// config.h files from before the forecast had its own interval
+#ifndef FORECAST_UPDATE_INTERVAL
+#define FORECAST_UPDATE_INTERVAL 10800000
+#endif
+
+// API calls per UTC day the refresh schedule stays within (the free tier
+// allows 1000); 0 disables the budget
+#ifndef DAILY_CALL_LIMIT
+#define DAILY_CALL_LIMIT 1000
+#endif
 
 // Configuration structure to hold all settings
 struct AppConfig {
     // WiFi settings
     char wifi_ssid[64];
     char wifi_password[64];
+    bool wifi_reuse_ip;
 
     // OpenWeatherMap API settings
+    char weather_api_host[64];
     char weather_api_key[64];
     char weather_city[64];
     char weather_country_code[8];
     char weather_units[16];
+    char weather_api_mode[12];
+    bool weather_api_https;
+    char weather_api_ca_file[32];
+    bool weather_api_insecure;
+    // City coordinates for One Call; 0/0 means take them from the first
+    // current weather response
+    float weather_lat;
+    float weather_lon;
 
     // Update interval
     unsigned long update_interval;
+    unsigned long forecast_interval;
+    unsigned long daily_call_limit;
 };
 
 // Global configuration instance
@@ -63,7 +121,7 @@ bool sd_config_init() {
     }
 
     uint64_t cardSize = SD.cardSize() / (1024 * 1024);
-    Serial.printf("SD Card Size: %lluMB\n", cardSize);
+    Serial.printf("SD Card Size: %lluMB\n", (unsigned long long)cardSize);
 
     return true;
 }
@@ -82,15 +140,26 @@ String sd_config_trim(String str) {
 void sd_config_set_defaults() {
     strncpy(appConfig.wifi_ssid, WIFI_SSID, sizeof(appConfig.wifi_ssid) - 1);
     strncpy(appConfig.wifi_password, WIFI_PASSWORD, sizeof(appConfig.wifi_password) - 1);
+    appConfig.wifi_reuse_ip = WIFI_REUSE_IP;
+    strncpy(appConfig.weather_api_host, WEATHER_API_HOST, sizeof(appConfig.weather_api_host) - 1);
     strncpy(appConfig.weather_api_key, WEATHER_API_KEY, sizeof(appConfig.weather_api_key) - 1);
     strncpy(appConfig.weather_city, WEATHER_CITY, sizeof(appConfig.weather_city) - 1);
     strncpy(appConfig.weather_country_code, WEATHER_COUNTRY_CODE, sizeof(appConfig.weather_country_code) - 1);
     strncpy(appConfig.weather_units, WEATHER_UNITS, sizeof(appConfig.weather_units) - 1);
+    strncpy(appConfig.weather_api_mode, WEATHER_API_MODE, sizeof(appConfig.weather_api_mode) - 1);
+    appConfig.weather_api_https = WEATHER_API_HTTPS;
+    strncpy(appConfig.weather_api_ca_file, WEATHER_API_CA_FILE, sizeof(appConfig.weather_api_ca_file) - 1);
+    appConfig.weather_api_insecure = WEATHER_API_INSECURE;
+    appConfig.weather_lat = 0.0f;
+    appConfig.weather_lon = 0.0f;
     appConfig.update_interval = UPDATE_INTERVAL;
+    appConfig.forecast_interval = FORECAST_UPDATE_INTERVAL;
+    appConfig.daily_call_limit = DAILY_CALL_LIMIT;
 }
 
 // Load configuration from SD card
 bool sd_config_load() {
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_SD_CONFIG_LOAD);
     // First set defaults from config.h
     sd_config_set_defaults();
 
@@ -176,6 +245,16 @@ bool sd_config_load() {
                 Serial.println("  ✓ wifi_password: ******** (hidden)");
                 settingsFound++;
             }
+            else if (key == "wifi_reuse_ip") {
+                appConfig.wifi_reuse_ip = value.toInt() != 0;
+                Serial.printf("  ✓ wifi_reuse_ip set to: %d\n", appConfig.wifi_reuse_ip);
+                settingsFound++;
+            }
+            else if (key == "weather_api_host") {
+                strncpy(appConfig.weather_api_host, value.c_str(), sizeof(appConfig.weather_api_host) - 1);
+                Serial.printf("  ✓ weather_api_host set to: %s\n", appConfig.weather_api_host);
+                settingsFound++;
+            }
             else if (key == "weather_api_key") {
                 strncpy(appConfig.weather_api_key, value.c_str(), sizeof(appConfig.weather_api_key) - 1);
                 Serial.println("  ✓ weather_api_key: ******** (hidden)");
@@ -196,11 +275,56 @@ bool sd_config_load() {
                 Serial.printf("  ✓ weather_units set to: %s\n", appConfig.weather_units);
                 settingsFound++;
             }
+            else if (key == "weather_api_mode") {
+                if (value == "auto" || value == "onecall" || value == "split") {
+                    strncpy(appConfig.weather_api_mode, value.c_str(), sizeof(appConfig.weather_api_mode) - 1);
+                    Serial.printf("  ✓ weather_api_mode set to: %s\n", appConfig.weather_api_mode);
+                    settingsFound++;
+                } else {
+                    Serial.printf("  ✗ Invalid weather_api_mode: %s (expected auto, onecall or split), keeping %s\n",
+                                  value.c_str(), appConfig.weather_api_mode);
+                }
+            }
+            else if (key == "weather_api_https") {
+                appConfig.weather_api_https = value.toInt() != 0;
+                Serial.printf("  ✓ weather_api_https set to: %d\n", appConfig.weather_api_https);
+                settingsFound++;
+            }
+            else if (key == "weather_api_ca_file") {
+                strncpy(appConfig.weather_api_ca_file, value.c_str(), sizeof(appConfig.weather_api_ca_file) - 1);
+                Serial.printf("  ✓ weather_api_ca_file set to: %s\n", appConfig.weather_api_ca_file);
+                settingsFound++;
+            }
+            else if (key == "weather_api_insecure") {
+                appConfig.weather_api_insecure = value.toInt() != 0;
+                Serial.printf("  ✓ weather_api_insecure set to: %d\n", appConfig.weather_api_insecure);
+                settingsFound++;
+            }
+            else if (key == "weather_lat") {
+                appConfig.weather_lat = value.toFloat();
+                Serial.printf("  ✓ weather_lat set to: %.4f\n", appConfig.weather_lat);
+                settingsFound++;
+            }
+            else if (key == "weather_lon") {
+                appConfig.weather_lon = value.toFloat();
+                Serial.printf("  ✓ weather_lon set to: %.4f\n", appConfig.weather_lon);
+                settingsFound++;
+            }
             else if (key == "update_interval") {
                 appConfig.update_interval = value.toInt();
                 Serial.printf("  ✓ update_interval set to: %lu ms\n", appConfig.update_interval);
                 settingsFound++;
             }
+            else if (key == "forecast_interval") {
+                appConfig.forecast_interval = value.toInt();
+                Serial.printf("  ✓ forecast_interval set to: %lu ms\n", appConfig.forecast_interval);
+                settingsFound++;
+            }
+            else if (key == "daily_call_limit") {
+                appConfig.daily_call_limit = value.toInt();
+                Serial.printf("  ✓ daily_call_limit set to: %lu\n", appConfig.daily_call_limit);
+                settingsFound++;
+            }
             else {
                 Serial.printf("  ✗ Unknown key: %s\n", key.c_str());
             }
@@ -219,10 +343,18 @@ bool sd_config_load() {
     // Print final configuration summary
     Serial.println("\nFinal Configuration:");
     Serial.printf("  WiFi SSID: %s\n", appConfig.wifi_ssid);
+    Serial.printf("  Reuse IP: %s\n", appConfig.wifi_reuse_ip ? "yes" : "no");
+    Serial.printf("  API Host: %s\n", appConfig.weather_api_host);
     Serial.printf("  Weather City: %s\n", appConfig.weather_city);
     Serial.printf("  Country Code: %s\n", appConfig.weather_country_code);
     Serial.printf("  Units: %s\n", appConfig.weather_units);
+    Serial.printf("  API Mode: %s\n", appConfig.weather_api_mode);
+    Serial.printf("  HTTPS: %s\n", !appConfig.weather_api_https     ? "no"
+                                     : appConfig.weather_api_insecure ? "yes, server NOT verified"
+                                                                      : "yes");
     Serial.printf("  Update Interval: %lu ms\n", appConfig.update_interval);
+    Serial.printf("  Forecast Interval: %lu ms\n", appConfig.forecast_interval);
+    Serial.printf("  Daily Call Limit: %lu\n", appConfig.daily_call_limit);
     Serial.println("=========================================\n");
 
     return true;
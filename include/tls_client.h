@@ -0,0 +1,75 @@
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// WiFiClient that speaks TLS and keeps the session of its last connection,
+// so the next connection resumes it (session ticket or session ID) instead
+// of paying for a full handshake: no certificate chain to receive and
+// verify, no key exchange. The RNG, the parsed CA certificates and the TLS
+// configuration are set up by the first secure connection and kept, so
+// later connections only pay for the handshake. The ESP32 build runs on
+// mbedtls (TLS 1.2); the native build on OpenSSL, limited to TLS 1.2 to match.
+// With setSecure(false) it is a plain WiFiClient, so one client object can
+// serve http:// and https:// hosts.
+
+#define TLS_HANDSHAKE_TIMEOUT_MS 10000
+
+class TlsClient : public WiFiClient {
+public:
+    TlsClient();
+    ~TlsClient() override;
+
+    void setSecure(bool secure);
+    bool secure() const { return _secure; }
+    // Name sent as SNI and checked against the certificate; needed when
+    // connecting to an address
+    void setServerName(const char *name);
+    // PEM of the CA(s) the server certificate must chain to, kept by the
+    // caller. Without one, a secure connection is refused unless
+    // setInsecure() was called. Changing it closes the connection and drops
+    // the saved session.
+    void setCACert(const char *pem);
+    // Encrypts without verifying the server; anyone on the path can read
+    // what is sent. Cleared by setCACert().
+    void setInsecure();
+    // Drops the saved session; the next connection does a full handshake
+    void forgetSession();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char *host, uint16_t port) override;
+    uint8_t connected() override;
+    void stop() override;
+
+    int available() override;
+    int read() override;
+    int read(uint8_t *buf, size_t size) override;
+    size_t readBytes(char *buffer, size_t length) override;
+    using Stream::readBytes;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+    // Last handshake: duration and whether the saved session was resumed
+    uint32_t lastHandshakeMs() const { return _handshake_ms; }
+    bool lastHandshakeResumed() const { return _resumed; }
+
+private:
+    struct Tls;
+
+    bool startTls(const char *host);
+    void stopTls();
+
+    Tls *_tls;
+    bool _secure = true;
+    char _server_name[64];
+    const char *_ca_pem = nullptr;
+    bool _insecure = false;
+    uint32_t _handshake_ms = 0;
+    bool _resumed = false;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef WEATHER_PARSE_H
+#define WEATHER_PARSE_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <time.h>
+
+// ArduinoJson slots double in size with 64-bit pointers; the native build
+// scales the documents so they hold the same payloads as on the ESP32.
+#ifndef JSON_CAPACITY_SCALE
+#define JSON_CAPACITY_SCALE 1
+#endif
+
+// JsonDocument sizes used for the OpenWeatherMap responses, deserialized
+// through the filters below: only the fields the parsers read are kept
+// (a 40-slot forecast needs about 5 KB instead of 20 KB)
+#define WEATHER_JSON_CAPACITY (768 * JSON_CAPACITY_SCALE)
+#define FORECAST_JSON_CAPACITY (8192 * JSON_CAPACITY_SCALE)
+// A forecast limited with cnt= gets the "city" part plus room per slot
+#define FORECAST_JSON_BASE_CAPACITY (512 * JSON_CAPACITY_SCALE)
+#define FORECAST_SLOT_JSON_CAPACITY (192 * JSON_CAPACITY_SCALE)
+// One Call with exclude=minutely,hourly,alerts: current conditions + 8 days
+#define ONECALL_JSON_CAPACITY (2048 * JSON_CAPACITY_SCALE)
+// One Call with the daily part excluded as well: current conditions only
+#define ONECALL_CURRENT_JSON_CAPACITY (768 * JSON_CAPACITY_SCALE)
+
+#define FORECAST_DAYS 3
+
+// time() before 1 Jan 2000 means NTP has not set the clock yet
+#define CLOCK_VALID_AFTER 946684800
+
+// /data/2.5/forecast: 3-hour slots, at most 40 (5 days)
+#define FORECAST_SLOT_SECONDS (3 * 3600)
+#define FORECAST_MAX_SLOTS 40
+
+// Weather data. Plain character buffers rather than String so finished
+// snapshots can be copied through a FreeRTOS queue by value.
+struct WeatherData {
+    float temperature;
+    float feels_like;
+    int humidity;
+    char description[64];
+    char icon[8];
+    char city[48];
+    char last_update_time[8];
+    long observed_at;           // "dt" of the observation, UTC seconds
+    float latitude;             // "coord" of the city, used for One Call
+    float longitude;
+};
+
+struct ForecastEntry {
+    char day[4];
+    float temp_min;
+    float temp_max;
+    char icon[8];
+    bool valid;
+};
+
+extern const char *DAY_NAMES[];
+
+// Copies src into a buffer of size bytes, truncating and always terminating
+void copy_text(char *dest, size_t size, const char *src);
+
+// "HH:MM" in the given UTC offset, or an empty string for a missing time
+void format_update_time(long epoch_seconds, long timezone_offset_seconds, char *out, size_t size);
+
+void reset_forecast_entries(ForecastEntry *entries, int count);
+// True when both lists would draw the same forecast
+bool forecast_entries_equal(const ForecastEntry *a, const ForecastEntry *b, int count);
+
+// Changes between two observations that count as fast-changing weather
+#define WEATHER_FAST_TEMP_DELTA 2.0f        // degrees, in the configured units
+#define WEATHER_FAST_HUMIDITY_DELTA 10      // percentage points
+
+// True when the conditions changed enough to refresh sooner (new kind of
+// weather, or a large temperature or humidity swing)
+bool weather_changed_fast(const WeatherData &before, const WeatherData &after);
+
+// Filters for deserializeJson(doc, input, DeserializationOption::Filter(...))
+// that keep the fields read by parse_current_weather, aggregate_forecast and
+// the One Call parsers respectively. Built on first use.
+const JsonDocument &current_weather_filter();
+const JsonDocument &forecast_filter();
+const JsonDocument &onecall_filter();
+
+// Copy the fields shown on screen out of a /data/2.5/weather document.
+// Returns the city's UTC offset in seconds.
+long parse_current_weather(JsonDocument &doc, WeatherData &out);
+
+// Collapse the 3-hour slots of a /data/2.5/forecast document into one entry
+// per day (min/max temperature, icon closest to midday), skipping the day
+// that contains now_utc (none while the clock is not set). Returns the
+// number of days filled.
+int aggregate_forecast(JsonDocument &doc, time_t now_utc, ForecastEntry *entries, int max_days);
+
+// Number of forecast slots (cnt=) that covers the rest of today plus the
+// given number of days in the city's local time. FORECAST_MAX_SLOTS when the
+// clock is not set yet.
+int forecast_slot_count(time_t now_utc, long timezone_offset, int days);
+size_t forecast_json_capacity(int slots);
+
+// Same for a One Call (/data/3.0/onecall) document: current conditions from
+// "current" (the city name is not part of the response and is left as is),
+// and one entry per day from "daily", skipping today. Returns the UTC offset
+// and the number of days filled respectively.
+long parse_onecall_current(JsonDocument &doc, WeatherData &out);
+int parse_onecall_daily(JsonDocument &doc, time_t now_utc, ForecastEntry *entries, int max_days);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef WEATHER_UI_H
+#define WEATHER_UI_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "weather_parse.h"
+
+// LVGL widgets of the weather screen. Kept apart from main.cpp so the host
+// benchmarks can build and render the same screen on the headless display.
+
+String transliterate_to_ascii(String str);
+
+const lv_img_dsc_t *get_icon_for_code(const char *icon_code);
+void set_icon_size(lv_obj_t *img_obj, uint16_t size_px);
+void set_icon_size_with_crop(lv_obj_t *img_obj, uint16_t size_px, float crop_factor);
+void update_weather_icon(const char *icon_code);
+
+void hide_status_message();
+void show_status_message(const char *message, uint32_t color);
+
+// Builds the weather screen on the active screen
+void create_ui();
+void update_ui(const WeatherData &weather);
+// entries must hold FORECAST_DAYS items
+void update_forecast_ui(const ForecastEntry *entries);
+void update_time_display(long timezone_offset);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Access point and address of the last successful WiFi connection, kept in
+// NVS so the next boot can join that BSSID on its channel directly: no scan
+// (2+ s) and, when the address is reused, no DHCP exchange either.
+// The entry belongs to one SSID; a different configured SSID ignores it.
+
+struct WifiCacheEntry {
+    uint8_t bssid[6];
+    int32_t channel;
+    // Lease of that connection, for connecting with a static configuration
+    IPAddress ip;
+    IPAddress gateway;
+    IPAddress subnet;
+    IPAddress dns;
+};
+
+// Entry saved for ssid, if there is one
+bool wifi_cache_load(const char *ssid, WifiCacheEntry &entry);
+// Stores the entry; NVS is only written when it changed
+void wifi_cache_save(const char *ssid, const WifiCacheEntry &entry);
+// Forgets the entry, e.g. after connecting with it failed
+void wifi_cache_clear();
+
+#endif
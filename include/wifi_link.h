@@ -0,0 +1,49 @@
+#ifndef WIFI_LINK_H
+#define WIFI_LINK_H
+
+#include <Arduino.h>
+
+// Keeps the station connected: connects at boot without blocking setup(),
+// and reconnects in the background whenever the link is lost. WiFi events
+// (WiFi.onEvent) arrive on the WiFi task and are only queued there; the state
+// machine runs in wifi_link_poll() on the loop task.
+//
+// An attempt first joins the cached access point (wifi_cache.h) and falls
+// back to letting the station pick one. After a full attempt fails, a scan
+// reports whether the SSID is in range, and attempts are retried with a delay
+// that doubles from WIFI_LINK_RETRY_MIN_MS up to WIFI_LINK_RETRY_MAX_MS. The
+// station's own auto-reconnect is turned off so attempts never overlap.
+
+#define WIFI_LINK_CACHED_TIMEOUT_MS 5000    // joining a known access point takes well under a second
+#define WIFI_LINK_CONNECT_TIMEOUT_MS 20000
+#define WIFI_LINK_SCAN_TIMEOUT_MS 15000
+#define WIFI_LINK_RETRY_MIN_MS 5000
+#define WIFI_LINK_RETRY_MAX_MS 60000
+
+enum WifiLinkState : uint8_t {
+    WIFI_LINK_IDLE,         // wifi_link_begin() not called yet
+    WIFI_LINK_CONNECTING,
+    WIFI_LINK_SCANNING,     // after a failed attempt, looking for the SSID
+    WIFI_LINK_WAITING,      // until the next attempt
+    WIFI_LINK_UP,
+};
+
+enum WifiLinkChange : uint8_t {
+    WIFI_LINK_NO_CHANGE,
+    WIFI_LINK_CAME_UP,      // connected and has an address
+    WIFI_LINK_WENT_DOWN,    // was up; reconnecting
+    WIFI_LINK_FAILED,       // an attempt gave up; retried later
+};
+
+// ssid and password must stay valid; reuse_ip connects to the cached access
+// point with the address of its last lease instead of asking DHCP
+void wifi_link_begin(const char *ssid, const char *password, bool reuse_ip);
+// Handles queued WiFi events, attempt timeouts and retries; call from loop()
+WifiLinkChange wifi_link_poll(uint32_t now_ms);
+bool wifi_link_up();
+WifiLinkState wifi_link_state();
+// Disconnects, as if the access point had dropped the station
+void wifi_link_drop();
+void wifi_link_print(Print &out, uint32_t now_ms);
+
+#endif
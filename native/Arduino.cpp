@@ -0,0 +1,99 @@
+#include "Arduino.h"
+
+#include <chrono>
+#include <random>
+#include <thread>
+
+static const auto boot_time = std::chrono::steady_clock::now();
+static std::minstd_rand random_engine;
+
+extern "C" unsigned long millis(void) {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - boot_time).count());
+}
+
+extern "C" unsigned long micros(void) {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - boot_time).count());
+}
+
+extern "C" void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+extern "C" void delayMicroseconds(uint32_t us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+extern "C" void yield(void) {
+    std::this_thread::yield();
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max) {
+    const long dividend = out_max - out_min;
+    const long divisor = in_max - in_min;
+    if (divisor == 0) {
+        return -1;
+    }
+    return (x - in_min) * dividend / divisor + out_min;
+}
+
+long random(long max) {
+    if (max <= 0) {
+        return 0;
+    }
+    return static_cast<long>(random_engine() % static_cast<unsigned long>(max));
+}
+
+long random(long min, long max) {
+    if (min >= max) {
+        return min;
+    }
+    return random(max - min) + min;
+}
+
+void randomSeed(unsigned long seed) {
+    if (seed != 0) {
+        random_engine.seed(seed);
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    (void)pin;
+    (void)val;
+}
+
+int digitalRead(uint8_t pin) {
+    (void)pin;
+    return LOW;
+}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t resolution_bits) {
+    (void)channel;
+    (void)resolution_bits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    (void)pin;
+    (void)channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    (void)channel;
+    (void)duty;
+}
+
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char *server1,
+                const char *server2, const char *server3) {
+    (void)gmtOffset_sec;
+    (void)daylightOffset_sec;
+    (void)server1;
+    (void)server2;
+    (void)server3;
+}
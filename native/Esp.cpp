@@ -0,0 +1,33 @@
+#include "Esp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "native_heap.h"
+
+EspClass ESP;
+
+static uint32_t free_from_usage(size_t in_use) {
+    return in_use < NATIVE_HEAP_SIZE ? static_cast<uint32_t>(NATIVE_HEAP_SIZE - in_use) : 0;
+}
+
+uint32_t EspClass::getHeapSize() {
+    return NATIVE_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return free_from_usage(native_heap_stats().in_use);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return free_from_usage(native_heap_stats().max_in_use);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return getFreeHeap();
+}
+
+void EspClass::restart() {
+    fflush(stdout);
+    exit(0);
+}
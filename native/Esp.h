@@ -0,0 +1,28 @@
+#ifndef NATIVE_ESP_H
+#define NATIVE_ESP_H
+
+#include <stdint.h>
+
+// Host stand-in for the EspClass heap queries. The numbers come from the
+// malloc wrappers in native_heap.cpp measured against a nominal heap of
+// NATIVE_HEAP_SIZE bytes, so free/min-free follow the firmware's own
+// allocations. glibc does not fragment like the ESP-IDF heap, so the largest
+// free block is simply the free heap.
+#ifndef NATIVE_HEAP_SIZE
+#define NATIVE_HEAP_SIZE (320U * 1024U)
+#endif
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize() { return 0; }
+    uint32_t getFreePsram() { return 0; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+#endif // NATIVE_ESP_H
@@ -0,0 +1,184 @@
+#include "FS.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+class FileImpl {
+public:
+    FileImpl(const String &host_path, const String &fs_path, FILE *file, DIR *dir)
+        : hostPath(host_path), fsPath(fs_path), fp(file), dp(dir) {
+        int slash = fsPath.lastIndexOf('/');
+        baseName = slash >= 0 ? fsPath.substring(slash + 1) : fsPath;
+    }
+    ~FileImpl() { close(); }
+
+    void close() {
+        if (fp) {
+            fclose(fp);
+            fp = nullptr;
+        }
+        if (dp) {
+            closedir(dp);
+            dp = nullptr;
+        }
+    }
+
+    String hostPath;
+    String fsPath;
+    String baseName;
+    FILE *fp;
+    DIR *dp;
+};
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buf, size_t size) {
+    if (!_p || !_p->fp) {
+        return 0;
+    }
+    return fwrite(buf, 1, size, _p->fp);
+}
+
+int File::available() {
+    if (!_p || !_p->fp) {
+        return 0;
+    }
+    long pos = ftell(_p->fp);
+    long remaining = static_cast<long>(size()) - pos;
+    return remaining > 0 ? static_cast<int>(remaining) : 0;
+}
+
+int File::read() {
+    if (!_p || !_p->fp) {
+        return -1;
+    }
+    int c = fgetc(_p->fp);
+    return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t *buf, size_t size) {
+    if (!_p || !_p->fp) {
+        return 0;
+    }
+    return fread(buf, 1, size, _p->fp);
+}
+
+int File::peek() {
+    if (!_p || !_p->fp) {
+        return -1;
+    }
+    int c = fgetc(_p->fp);
+    if (c == EOF) {
+        return -1;
+    }
+    ungetc(c, _p->fp);
+    return c;
+}
+
+void File::flush() {
+    if (_p && _p->fp) {
+        fflush(_p->fp);
+    }
+}
+
+size_t File::size() const {
+    if (!_p) {
+        return 0;
+    }
+    struct stat st;
+    if (stat(_p->hostPath.c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+void File::close() {
+    if (_p) {
+        _p->close();
+        _p.reset();
+    }
+}
+
+File::operator bool() const {
+    return _p && (_p->fp || _p->dp);
+}
+
+const char *File::name() const {
+    return _p ? _p->baseName.c_str() : nullptr;
+}
+
+const char *File::path() const {
+    return _p ? _p->fsPath.c_str() : nullptr;
+}
+
+bool File::isDirectory() const {
+    return _p && _p->dp;
+}
+
+File File::openNextFile(const char *mode) {
+    if (!_p || !_p->dp) {
+        return File();
+    }
+    struct dirent *entry;
+    while ((entry = readdir(_p->dp)) != nullptr) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        String child_fs = _p->fsPath;
+        if (!child_fs.endsWith("/")) {
+            child_fs += "/";
+        }
+        child_fs += entry->d_name;
+        String child_host = _p->hostPath + "/" + entry->d_name;
+
+        struct stat st;
+        if (stat(child_host.c_str(), &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            return File(std::make_shared<FileImpl>(child_host, child_fs, nullptr, opendir(child_host.c_str())));
+        }
+        return File(std::make_shared<FileImpl>(child_host, child_fs, fopen(child_host.c_str(), mode), nullptr));
+    }
+    return File();
+}
+
+String FS::hostPath(const char *path) const {
+    String result = _root;
+    if (path && *path && strcmp(path, "/") != 0) {
+        result += path;
+    }
+    return result;
+}
+
+File FS::open(const char *path, const char *mode) {
+    String host = hostPath(path);
+    struct stat st;
+    if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(host.c_str());
+        return dir ? File(std::make_shared<FileImpl>(host, path, nullptr, dir)) : File();
+    }
+    FILE *fp = fopen(host.c_str(), mode);
+    return fp ? File(std::make_shared<FileImpl>(host, path, fp, nullptr)) : File();
+}
+
+bool FS::exists(const char *path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char *path) {
+    return unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::mkdir(const char *path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+} // namespace fs
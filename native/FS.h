@@ -0,0 +1,65 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <memory>
+
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+
+// Files and directories are backed by a directory on the host file system
+// (see SDFS::begin), so conf.txt can be edited next to the binary.
+class File : public Stream {
+public:
+    File(FileImplPtr p = FileImplPtr()) : _p(p) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+    size_t read(uint8_t *buf, size_t size);
+    size_t size() const;
+    void close();
+    operator bool() const;
+    const char *name() const;
+    const char *path() const;
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+
+private:
+    FileImplPtr _p;
+};
+
+class FS {
+public:
+    explicit FS(const String &root = String()) : _root(root) {}
+
+    File open(const char *path, const char *mode = FILE_READ);
+    File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool mkdir(const char *path);
+
+protected:
+    String _root;
+
+    String hostPath(const char *path) const;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+#endif // NATIVE_FS_H
@@ -0,0 +1,394 @@
+#include "HTTPClient.h"
+
+#include <stdlib.h>
+
+HTTPClient::HTTPClient() {}
+
+HTTPClient::~HTTPClient() {
+    if (_ownClient) {
+        _ownClient->stop();
+    }
+    delete[] _currentHeaders;
+}
+
+bool HTTPClient::beginInternal(String url) {
+    int index = url.indexOf(':');
+    if (index < 0) {
+        return false;
+    }
+    String protocol = url.substring(0, index);
+    if (protocol != "http" && protocol != "https") {
+        Serial.printf("[HTTP-Client] unsupported protocol: %s\n", protocol.c_str());
+        return false;
+    }
+    url.remove(0, index + 3);
+
+    index = url.indexOf('/');
+    String host = index >= 0 ? url.substring(0, index) : url;
+    _uri = index >= 0 ? url.substring(index) : String("/");
+
+    index = host.indexOf(':');
+    if (index >= 0) {
+        _host = host.substring(0, index);
+        _port = static_cast<uint16_t>(host.substring(index + 1).toInt());
+    } else {
+        _host = host;
+        _port = protocol == "https" ? 443 : 80;
+    }
+    applyHostOverride();
+    return true;
+}
+
+void HTTPClient::applyHostOverride() {
+    const char *override_host = getenv("WS_HTTP_HOST");
+    if (!override_host || !*override_host) {
+        return;
+    }
+    String target(override_host);
+    int colon = target.indexOf(':');
+    if (colon >= 0) {
+        _host = target.substring(0, colon);
+        _port = static_cast<uint16_t>(target.substring(colon + 1).toInt());
+    } else {
+        _host = target;
+    }
+}
+
+bool HTTPClient::begin(String url) {
+    if (_client && !_ownClient) {
+        _client = nullptr;
+    }
+    if (!beginInternal(url)) {
+        return false;
+    }
+    if (!_ownClient) {
+        _ownClient.reset(new WiFiClient());
+    }
+    _client = _ownClient.get();
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient &client, String url) {
+    _ownClient.reset();
+    _client = &client;
+    return beginInternal(url);
+}
+
+bool HTTPClient::begin(WiFiClient &client, String host, uint16_t port, String uri, bool https) {
+    if (https) {
+        Serial.println("[HTTP-Client] https is not supported by the native client");
+        return false;
+    }
+    _ownClient.reset();
+    _client = &client;
+    _host = host;
+    _port = port;
+    _uri = uri;
+    applyHostOverride();
+    return true;
+}
+
+void HTTPClient::disconnect(bool preserveClient) {
+    if (!_client) {
+        return;
+    }
+    if (connected()) {
+        while (_client->available() > 0) {
+            _client->read();
+        }
+        if (_reuse && _canReuse) {
+            return;
+        }
+        _client->stop();
+    }
+    if (!preserveClient) {
+        _client = nullptr;
+    }
+}
+
+void HTTPClient::end() {
+    disconnect(false);
+    _headers = "";
+    _size = -1;
+    _returnCode = 0;
+}
+
+bool HTTPClient::connected() {
+    return _client && _client->connected();
+}
+
+void HTTPClient::addHeader(const String &name, const String &value, bool first, bool replace) {
+    if (name.equalsIgnoreCase("Connection") || name.equalsIgnoreCase("User-Agent") ||
+        name.equalsIgnoreCase("Host")) {
+        return;
+    }
+    String headerLine = name + ": ";
+    if (replace) {
+        int headerStart = _headers.indexOf(headerLine);
+        if (headerStart != -1) {
+            int headerEnd = _headers.indexOf('\n', headerStart);
+            _headers = _headers.substring(0, headerStart) + _headers.substring(headerEnd + 1);
+        }
+    }
+    headerLine += value;
+    headerLine += "\r\n";
+    if (first) {
+        _headers = headerLine + _headers;
+    } else {
+        _headers += headerLine;
+    }
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+    delete[] _currentHeaders;
+    _headerKeysCount = headerKeysCount;
+    _currentHeaders = new RequestArgument[_headerKeysCount];
+    for (size_t i = 0; i < _headerKeysCount; i++) {
+        _currentHeaders[i].key = headerKeys[i];
+    }
+}
+
+String HTTPClient::header(const char *name) {
+    for (size_t i = 0; i < _headerKeysCount; ++i) {
+        if (_currentHeaders[i].key.equalsIgnoreCase(name)) {
+            return _currentHeaders[i].value;
+        }
+    }
+    return String();
+}
+
+bool HTTPClient::hasHeader(const char *name) {
+    for (size_t i = 0; i < _headerKeysCount; ++i) {
+        if (_currentHeaders[i].key.equalsIgnoreCase(name) && _currentHeaders[i].value.length() > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HTTPClient::connect() {
+    if (connected()) {
+        if (_reuse) {
+            return true;
+        }
+        _client->stop();
+    }
+    if (!_client) {
+        return false;
+    }
+    _client->setTimeout(_connectTimeout > 0 ? _connectTimeout : _tcpTimeout);
+    if (!_client->connect(_host.c_str(), _port)) {
+        Serial.printf("[HTTP-Client] failed connect to %s:%u\n", _host.c_str(), _port);
+        return false;
+    }
+    _client->setTimeout(_tcpTimeout);
+    return connected();
+}
+
+bool HTTPClient::sendHeader(const char *type) {
+    if (!connected()) {
+        return false;
+    }
+    String header = String(type) + " " + _uri + " HTTP/1.";
+    header += _useHTTP10 ? "0" : "1";
+    header += "\r\nHost: ";
+    header += _host;
+    if (_port != 80 && _port != 443) {
+        header += ':';
+        header += String(static_cast<unsigned int>(_port));
+    }
+    header += "\r\nUser-Agent: ";
+    header += _userAgent;
+    header += "\r\nConnection: ";
+    header += _reuse ? "keep-alive" : "close";
+    header += "\r\n";
+    if (!_useHTTP10) {
+        header += "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+    }
+    header += _headers;
+    header += "\r\n";
+    return _client->write(reinterpret_cast<const uint8_t *>(header.c_str()), header.length()) == header.length();
+}
+
+int HTTPClient::handleHeaderResponse() {
+    if (!connected()) {
+        return HTTPC_ERROR_NOT_CONNECTED;
+    }
+
+    _returnCode = 0;
+    _size = -1;
+    _canReuse = _reuse;
+    _transferEncoding = HTTPC_TE_IDENTITY;
+    for (size_t i = 0; i < _headerKeysCount; ++i) {
+        _currentHeaders[i].value = "";
+    }
+
+    bool firstLine = true;
+    unsigned long lastDataTime = millis();
+    while (connected()) {
+        if (_client->available() <= 0) {
+            if (millis() - lastDataTime > _tcpTimeout) {
+                return HTTPC_ERROR_READ_TIMEOUT;
+            }
+            delay(1);
+            continue;
+        }
+
+        String headerLine = _client->readStringUntil('\n');
+        headerLine.trim();
+        lastDataTime = millis();
+
+        if (firstLine) {
+            firstLine = false;
+            if (_canReuse && headerLine.startsWith("HTTP/1.")) {
+                _canReuse = (headerLine[sizeof "HTTP/1." - 1] != '0');
+            }
+            int codePos = headerLine.indexOf(' ') + 1;
+            _returnCode = static_cast<int>(headerLine.substring(codePos, headerLine.indexOf(' ', codePos)).toInt());
+            continue;
+        }
+
+        if (headerLine.length() == 0) {
+            if (_returnCode == 0) {
+                return HTTPC_ERROR_NO_HTTP_SERVER;
+            }
+            return _returnCode;
+        }
+
+        int colon = headerLine.indexOf(':');
+        if (colon <= 0) {
+            continue;
+        }
+        String headerName = headerLine.substring(0, colon);
+        String headerValue = headerLine.substring(colon + 1);
+        headerValue.trim();
+
+        if (headerName.equalsIgnoreCase("Content-Length")) {
+            _size = static_cast<int>(headerValue.toInt());
+        }
+        if (_canReuse && headerName.equalsIgnoreCase("Connection")) {
+            if (headerValue.indexOf("close") >= 0 && headerValue.indexOf("keep-alive") < 0) {
+                _canReuse = false;
+            }
+        }
+        if (headerName.equalsIgnoreCase("Transfer-Encoding") && headerValue.equalsIgnoreCase("chunked")) {
+            _transferEncoding = HTTPC_TE_CHUNKED;
+        }
+        for (size_t i = 0; i < _headerKeysCount; ++i) {
+            if (_currentHeaders[i].key.equalsIgnoreCase(headerName)) {
+                _currentHeaders[i].value = headerValue;
+                break;
+            }
+        }
+    }
+    return HTTPC_ERROR_CONNECTION_LOST;
+}
+
+int HTTPClient::returnError(int error) {
+    if (error < 0 && connected()) {
+        _client->stop();
+    }
+    return error;
+}
+
+int HTTPClient::sendRequest(const char *type, uint8_t *payload, size_t size) {
+    if (!connect()) {
+        return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+    }
+    if (payload && size > 0) {
+        addHeader("Content-Length", String(static_cast<unsigned long>(size)));
+    }
+    if (!sendHeader(type)) {
+        return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+    }
+    if (payload && size > 0 && _client->write(payload, size) != size) {
+        return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+    }
+    return returnError(handleHeaderResponse());
+}
+
+int HTTPClient::GET() {
+    return sendRequest("GET");
+}
+
+WiFiClient &HTTPClient::getStream() {
+    return *_client;
+}
+
+WiFiClient *HTTPClient::getStreamPtr() {
+    return connected() ? _client : nullptr;
+}
+
+String HTTPClient::getString() {
+    String payload;
+    if (!connected()) {
+        return payload;
+    }
+    if (_size > 0) {
+        payload.reserve(_size);
+    }
+
+    char buffer[1024];
+    if (_transferEncoding == HTTPC_TE_IDENTITY) {
+        int remaining = _size;
+        while (connected() && (_size < 0 || remaining > 0)) {
+            size_t want = sizeof(buffer);
+            if (_size >= 0 && static_cast<size_t>(remaining) < want) {
+                want = remaining;
+            }
+            size_t got = _client->readBytes(buffer, want);
+            if (got == 0) {
+                break;
+            }
+            payload.concat(buffer, got);
+            remaining -= static_cast<int>(got);
+        }
+        if (_size < 0) {
+            _canReuse = false;
+        }
+        return payload;
+    }
+
+    while (connected()) {
+        String chunkHeader = _client->readStringUntil('\n');
+        chunkHeader.trim();
+        if (chunkHeader.length() == 0) {
+            break;
+        }
+        long chunkSize = strtol(chunkHeader.c_str(), nullptr, 16);
+        if (chunkSize <= 0) {
+            // Consume the (empty) trailer so the connection can be reused
+            _client->readStringUntil('\n');
+            break;
+        }
+        while (chunkSize > 0) {
+            size_t want = chunkSize < static_cast<long>(sizeof(buffer)) ? chunkSize : sizeof(buffer);
+            size_t got = _client->readBytes(buffer, want);
+            if (got == 0) {
+                _canReuse = false;
+                return payload;
+            }
+            payload.concat(buffer, got);
+            chunkSize -= static_cast<long>(got);
+        }
+        _client->readStringUntil('\n');
+    }
+    return payload;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED: return "connection refused";
+        case HTTPC_ERROR_SEND_HEADER_FAILED: return "send header failed";
+        case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+        case HTTPC_ERROR_NOT_CONNECTED: return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST: return "connection lost";
+        case HTTPC_ERROR_NO_STREAM: return "no stream";
+        case HTTPC_ERROR_NO_HTTP_SERVER: return "no HTTP server";
+        case HTTPC_ERROR_TOO_LESS_RAM: return "too less ram";
+        case HTTPC_ERROR_ENCODING: return "Transfer-Encoding not supported";
+        case HTTPC_ERROR_STREAM_WRITE: return "Stream write error";
+        case HTTPC_ERROR_READ_TIMEOUT: return "read Timeout";
+        default: return String();
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef NATIVE_HTTPCLIENT_H
+#define NATIVE_HTTPCLIENT_H
+
+#include <memory>
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_TOO_MANY_REQUESTS = 429,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503,
+} t_http_codes;
+
+typedef enum {
+    HTTPC_TE_IDENTITY,
+    HTTPC_TE_CHUNKED
+} transferEncoding_t;
+
+// HTTP/1.1 client with the same request/response behaviour as the
+// arduino-esp32 HTTPClient: the default Accept-Encoding line, keep-alive when
+// setReuse(true), and getStream() returning the raw socket (chunked framing
+// is not removed there, only in getString()).
+//
+// Setting WS_HTTP_HOST=host:port in the environment redirects every request
+// to that server, e.g. the local mock in tools/mock_owm_server.py, including
+// requests on a connection the firmware opened to a resolved address.
+class HTTPClient {
+public:
+    HTTPClient();
+    ~HTTPClient();
+
+    bool begin(String url);
+    bool begin(WiFiClient &client, String url);
+    bool begin(WiFiClient &client, String host, uint16_t port, String uri = "/", bool https = false);
+    void end();
+    bool connected();
+
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void setUserAgent(const String &userAgent) { _userAgent = userAgent; }
+    void setTimeout(uint16_t timeout) { _tcpTimeout = timeout; }
+    void setConnectTimeout(int32_t connectTimeout) { _connectTimeout = connectTimeout; }
+    void useHTTP10(bool usehttp10 = true) {
+        _useHTTP10 = usehttp10;
+        _reuse = !usehttp10;
+    }
+
+    void addHeader(const String &name, const String &value, bool first = false, bool replace = true);
+    void collectHeaders(const char *headerKeys[], const size_t headerKeysCount);
+    String header(const char *name);
+    bool hasHeader(const char *name);
+
+    int GET();
+    int sendRequest(const char *type, uint8_t *payload = nullptr, size_t size = 0);
+
+    int getSize() { return _size; }
+    WiFiClient &getStream();
+    WiFiClient *getStreamPtr();
+    String getString();
+
+    static String errorToString(int error);
+
+protected:
+    struct RequestArgument {
+        String key;
+        String value;
+    };
+
+    WiFiClient *_client = nullptr;
+    std::unique_ptr<WiFiClient> _ownClient;
+
+    String _host;
+    uint16_t _port = 0;
+    String _uri;
+    String _headers;
+    String _userAgent = "ESP32HTTPClient";
+    bool _reuse = true;
+    bool _useHTTP10 = false;
+    bool _canReuse = false;
+    uint16_t _tcpTimeout = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    int32_t _connectTimeout = -1;
+
+    int _returnCode = 0;
+    int _size = -1;
+    transferEncoding_t _transferEncoding = HTTPC_TE_IDENTITY;
+    RequestArgument *_currentHeaders = nullptr;
+    size_t _headerKeysCount = 0;
+
+    bool beginInternal(String url);
+    void applyHostOverride();
+    bool connect();
+    bool sendHeader(const char *type);
+    int handleHeaderResponse();
+    int returnError(int error);
+    void disconnect(bool preserveClient = false);
+};
+
+#endif // NATIVE_HTTPCLIENT_H
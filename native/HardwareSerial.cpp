@@ -0,0 +1,52 @@
+#include "HardwareSerial.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+
+void HardwareSerial::begin(unsigned long baud) {
+    (void)baud;
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+}
+
+int HardwareSerial::available() {
+    if (_peeked >= 0) {
+        return 1;
+    }
+    struct pollfd fds = {STDIN_FILENO, POLLIN, 0};
+    return (poll(&fds, 1, 0) > 0 && (fds.revents & POLLIN)) ? 1 : 0;
+}
+
+int HardwareSerial::read() {
+    if (_peeked >= 0) {
+        int c = _peeked;
+        _peeked = -1;
+        return c;
+    }
+    if (!available()) {
+        return -1;
+    }
+    unsigned char c;
+    return ::read(STDIN_FILENO, &c, 1) == 1 ? c : -1;
+}
+
+int HardwareSerial::peek() {
+    if (_peeked < 0) {
+        _peeked = read();
+    }
+    return _peeked;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    return fwrite(buffer, 1, size, stdout);
+}
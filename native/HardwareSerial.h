@@ -0,0 +1,30 @@
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include "Stream.h"
+
+// Serial maps to stdout for output and to a non-blocking stdin for input,
+// so commands typed into the terminal reach the firmware like a serial monitor.
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud);
+    void end() {}
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() override;
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    operator bool() const { return true; }
+
+private:
+    int _peeked = -1;
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
@@ -0,0 +1,52 @@
+#ifndef NATIVE_IPADDRESS_H
+#define NATIVE_IPADDRESS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "WString.h"
+
+class IPAddress {
+public:
+    IPAddress() : _address{0, 0, 0, 0} {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d} {}
+    explicit IPAddress(uint32_t address) {
+        for (int i = 0; i < 4; ++i) {
+            _address[i] = static_cast<uint8_t>(address >> (8 * i));
+        }
+    }
+
+    bool fromString(const char *address) {
+        unsigned int a, b, c, d;
+        char trailing;
+        if (sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &trailing) != 4 ||
+            a > 255 || b > 255 || c > 255 || d > 255) {
+            return false;
+        }
+        _address[0] = a;
+        _address[1] = b;
+        _address[2] = c;
+        _address[3] = d;
+        return true;
+    }
+    bool fromString(const String &address) { return fromString(address.c_str()); }
+
+    operator uint32_t() const {
+        return static_cast<uint32_t>(_address[0]) | (static_cast<uint32_t>(_address[1]) << 8) |
+               (static_cast<uint32_t>(_address[2]) << 16) | (static_cast<uint32_t>(_address[3]) << 24);
+    }
+    bool operator==(const IPAddress &rhs) const { return static_cast<uint32_t>(*this) == static_cast<uint32_t>(rhs); }
+    uint8_t operator[](int index) const { return _address[index]; }
+    uint8_t &operator[](int index) { return _address[index]; }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+        return String(buf);
+    }
+
+private:
+    uint8_t _address[4];
+};
+
+#endif // NATIVE_IPADDRESS_H
@@ -0,0 +1,65 @@
+#include "Preferences.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partition_label) {
+    (void)partition_label;
+    const char *root = getenv("WS_NVS_ROOT");
+    _root = (root && *root) ? root : "nvs";
+    _name = name;
+    _readOnly = readOnly;
+    // Like NVS, opening a namespace that was never written fails read-only
+    struct stat st;
+    _started = !readOnly || (stat(_root.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+    return _started;
+}
+
+void Preferences::end() {
+    _started = false;
+}
+
+String Preferences::path(const char *key) const {
+    return _root + "/" + _name + "." + key;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    struct stat st;
+    if (!_started || stat(path(key).c_str(), &st) != 0) {
+        return 0;
+    }
+    return static_cast<size_t>(st.st_size);
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+    const size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLen) {
+        return 0;
+    }
+    FILE *file = fopen(path(key).c_str(), "rb");
+    if (!file) {
+        return 0;
+    }
+    const size_t read = fread(buf, 1, length, file);
+    fclose(file);
+    return read;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+    if (!_started || _readOnly) {
+        return 0;
+    }
+    mkdir(_root.c_str(), 0755);
+    FILE *file = fopen(path(key).c_str(), "wb");
+    if (!file) {
+        return 0;
+    }
+    const size_t written = fwrite(value, 1, len, file);
+    fclose(file);
+    return written;
+}
+
+bool Preferences::remove(const char *key) {
+    return _started && !_readOnly && ::remove(path(key).c_str()) == 0;
+}
@@ -0,0 +1,29 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include "Arduino.h"
+
+// NVS key/value store of arduino-esp32, limited to the byte blobs the
+// firmware uses. Each key is a file <namespace>.<key> in the directory named
+// by WS_NVS_ROOT (default: ./nvs, created on the first write), so what one run
+// stores is there on the next "boot".
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partition_label = nullptr);
+    void end();
+
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+    size_t putBytes(const char *key, const void *value, size_t len);
+    bool remove(const char *key);
+
+private:
+    String path(const char *key) const;
+
+    String _root;
+    String _name;
+    bool _started = false;
+    bool _readOnly = false;
+};
+
+#endif // NATIVE_PREFERENCES_H
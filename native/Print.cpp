@@ -0,0 +1,138 @@
+#include "Print.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+        n += write(*buffer++);
+    }
+    return n;
+}
+
+size_t Print::write(const char *str) {
+    if (!str) {
+        return 0;
+    }
+    return write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+}
+
+size_t Print::printf(const char *format, ...) {
+    char loc_buf[64];
+    va_list arg;
+    va_start(arg, format);
+    int len = vsnprintf(loc_buf, sizeof(loc_buf), format, arg);
+    va_end(arg);
+    if (len < 0) {
+        return 0;
+    }
+    if (static_cast<size_t>(len) < sizeof(loc_buf)) {
+        return write(loc_buf, len);
+    }
+
+    char *temp = static_cast<char *>(malloc(len + 1));
+    if (!temp) {
+        return 0;
+    }
+    va_start(arg, format);
+    vsnprintf(temp, len + 1, format, arg);
+    va_end(arg);
+    size_t written = write(temp, len);
+    free(temp);
+    return written;
+}
+
+size_t Print::print(const String &s) {
+    return write(s.c_str(), s.length());
+}
+
+size_t Print::print(const char *str) {
+    return write(str);
+}
+
+size_t Print::print(char c) {
+    return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(unsigned char value, int base) {
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(int value, int base) {
+    return print(static_cast<long>(value), base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(unsigned long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(long long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(unsigned long long value, int base) {
+    return print(String(value, static_cast<unsigned char>(base)));
+}
+
+size_t Print::print(double value, int digits) {
+    return print(String(value, static_cast<unsigned int>(digits)));
+}
+
+size_t Print::println() {
+    return write("\r\n");
+}
+
+size_t Print::println(const String &s) {
+    return print(s) + println();
+}
+
+size_t Print::println(const char *str) {
+    return print(str) + println();
+}
+
+size_t Print::println(char c) {
+    return print(c) + println();
+}
+
+size_t Print::println(unsigned char value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(long long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long long value, int base) {
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits) {
+    return print(value, digits) + println();
+}
@@ -0,0 +1,44 @@
+#include "SD.h"
+
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+SPIClass SPI(VSPI);
+fs::SDFS SD;
+
+namespace fs {
+
+bool SDFS::begin(uint8_t ssPin, SPIClass &spi, uint32_t frequency, const char *mountpoint, uint8_t max_files,
+                 bool format_if_empty) {
+    (void)ssPin;
+    (void)spi;
+    (void)frequency;
+    (void)mountpoint;
+    (void)max_files;
+    (void)format_if_empty;
+
+    const char *root = getenv("WS_SD_ROOT");
+    _root = (root && *root) ? root : "sd";
+    while (_root.length() > 1 && _root.endsWith("/")) {
+        _root.remove(_root.length() - 1);
+    }
+
+    struct stat st;
+    _mounted = stat(_root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    return _mounted;
+}
+
+sdcard_type_t SDFS::cardType() {
+    return _mounted ? CARD_SDHC : CARD_NONE;
+}
+
+uint64_t SDFS::cardSize() {
+    struct statvfs vfs;
+    if (!_mounted || statvfs(_root.c_str(), &vfs) != 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>(vfs.f_blocks) * vfs.f_frsize;
+}
+
+} // namespace fs
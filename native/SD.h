@@ -0,0 +1,36 @@
+#ifndef NATIVE_SD_H
+#define NATIVE_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum {
+    CARD_NONE,
+    CARD_MMC,
+    CARD_SD,
+    CARD_SDHC,
+    CARD_UNKNOWN
+} sdcard_type_t;
+
+namespace fs {
+
+// The "card" is the directory named by WS_SD_ROOT (default: ./sd).
+// begin() fails when that directory does not exist, which exercises the
+// firmware's "no SD card" fallback to config.h.
+class SDFS : public FS {
+public:
+    bool begin(uint8_t ssPin = 5, SPIClass &spi = SPI, uint32_t frequency = 4000000,
+               const char *mountpoint = "/sd", uint8_t max_files = 5, bool format_if_empty = false);
+    void end() { _mounted = false; }
+    sdcard_type_t cardType();
+    uint64_t cardSize();
+
+private:
+    bool _mounted = false;
+};
+
+} // namespace fs
+
+extern fs::SDFS SD;
+
+#endif // NATIVE_SD_H
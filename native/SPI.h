@@ -0,0 +1,33 @@
+#ifndef NATIVE_SPI_H
+#define NATIVE_SPI_H
+
+#include <stdint.h>
+
+#define FSPI 1
+#define HSPI 2
+#define VSPI 3
+
+// Bus object only; nothing is attached to it on the host.
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t spi_bus = HSPI) : _spi_num(spi_bus) {}
+
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+        (void)sck;
+        (void)miso;
+        (void)mosi;
+        (void)ss;
+    }
+    void end() {}
+    void setFrequency(uint32_t freq) { _freq = freq; }
+    uint32_t getFrequency() const { return _freq; }
+    uint8_t bus() const { return _spi_num; }
+
+private:
+    uint8_t _spi_num;
+    uint32_t _freq = 1000000;
+};
+
+extern SPIClass SPI;
+
+#endif // NATIVE_SPI_H
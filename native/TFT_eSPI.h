@@ -0,0 +1,90 @@
+#ifndef NATIVE_TFT_ESPI_H
+#define NATIVE_TFT_ESPI_H
+
+#include "Arduino.h"
+#include "SPI.h"
+
+#ifndef TFT_WIDTH
+#define TFT_WIDTH 240
+#endif
+
+#ifndef TFT_HEIGHT
+#define TFT_HEIGHT 320
+#endif
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_BLUE 0x001F
+
+// Display controller stand-in. Draw calls are accepted and counted; nothing
+// is rendered. Pixel output on the host goes through the headless LVGL
+// display driver instead.
+class TFT_eSPI : public Print {
+public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT) : _init_width(w), _init_height(h) {}
+
+    void init(uint8_t tc = 0) { (void)tc; }
+    void begin(uint8_t tc = 0) { init(tc); }
+    void setRotation(uint8_t r) { _rotation = r; }
+    uint8_t getRotation() const { return _rotation; }
+    int16_t width() const { return (_rotation & 1) ? _init_height : _init_width; }
+    int16_t height() const { return (_rotation & 1) ? _init_width : _init_height; }
+
+    void startWrite() {}
+    void endWrite() {}
+    void setAddrWindow(int32_t x, int32_t y, int32_t w, int32_t h) {
+        (void)x;
+        (void)y;
+        (void)w;
+        (void)h;
+    }
+    void pushColors(uint16_t *data, uint32_t len, bool swap = true) {
+        (void)data;
+        (void)swap;
+        _pixels_pushed += len;
+    }
+    void pushColor(uint16_t color, uint32_t len) {
+        (void)color;
+        _pixels_pushed += len;
+    }
+    void setSwapBytes(bool swap) { _swap_bytes = swap; }
+    bool getSwapBytes() const { return _swap_bytes; }
+
+    void fillScreen(uint32_t color) { fillRect(0, 0, width(), height(), color); }
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+        (void)x;
+        (void)y;
+        (void)color;
+        _pixels_pushed += static_cast<uint64_t>(w) * static_cast<uint64_t>(h);
+    }
+
+    void setTextColor(uint16_t color) { (void)color; }
+    void setTextColor(uint16_t fgcolor, uint16_t bgcolor) {
+        (void)fgcolor;
+        (void)bgcolor;
+    }
+    void setTextSize(uint8_t size) { (void)size; }
+    void setCursor(int16_t x, int16_t y) {
+        (void)x;
+        (void)y;
+    }
+
+    size_t write(uint8_t c) override {
+        (void)c;
+        return 1;
+    }
+    using Print::write;
+
+    uint64_t pixelsPushed() const { return _pixels_pushed; }
+
+private:
+    int16_t _init_width;
+    int16_t _init_height;
+    uint8_t _rotation = 0;
+    bool _swap_bytes = false;
+    uint64_t _pixels_pushed = 0;
+};
+
+#endif // NATIVE_TFT_ESPI_H
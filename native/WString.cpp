@@ -0,0 +1,431 @@
+#include "WString.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+String::String(const char *cstr) {
+    if (cstr) {
+        copy(cstr, strlen(cstr));
+    }
+}
+
+String::String(const char *cstr, unsigned int length) {
+    if (cstr) {
+        copy(cstr, length);
+    }
+}
+
+String::String(const String &str) {
+    *this = str;
+}
+
+String::String(String &&rval) noexcept {
+    move(rval);
+}
+
+String::String(char c) {
+    char buf[2] = {c, 0};
+    *this = buf;
+}
+
+String::String(unsigned char value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(int value, unsigned char base) : String(static_cast<long>(value), base) {}
+
+String::String(unsigned int value, unsigned char base) : String(static_cast<unsigned long>(value), base) {}
+
+String::String(long value, unsigned char base) {
+    char buf[2 + 8 * sizeof(long)];
+    if (base == 10) {
+        snprintf(buf, sizeof(buf), "%ld", value);
+    } else if (base == 16) {
+        snprintf(buf, sizeof(buf), "%lx", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%lo", value);
+    }
+    *this = buf;
+}
+
+String::String(unsigned long value, unsigned char base) {
+    char buf[1 + 8 * sizeof(unsigned long)];
+    if (base == 10) {
+        snprintf(buf, sizeof(buf), "%lu", value);
+    } else if (base == 16) {
+        snprintf(buf, sizeof(buf), "%lx", value);
+    } else {
+        snprintf(buf, sizeof(buf), "%lo", value);
+    }
+    *this = buf;
+}
+
+String::String(long long value, unsigned char base) {
+    char buf[2 + 8 * sizeof(long long)];
+    snprintf(buf, sizeof(buf), base == 16 ? "%llx" : "%lld", value);
+    *this = buf;
+}
+
+String::String(unsigned long long value, unsigned char base) {
+    char buf[1 + 8 * sizeof(unsigned long long)];
+    snprintf(buf, sizeof(buf), base == 16 ? "%llx" : "%llu", value);
+    *this = buf;
+}
+
+String::String(float value, unsigned int decimalPlaces) : String(static_cast<double>(value), decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", static_cast<int>(decimalPlaces), value);
+    *this = buf;
+}
+
+String::~String() {
+    free(buffer);
+}
+
+void String::invalidate() {
+    free(buffer);
+    buffer = nullptr;
+    capacity = 0;
+    len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+    if (buffer && capacity >= size) {
+        return true;
+    }
+    if (changeBuffer(size)) {
+        if (len == 0) {
+            buffer[0] = 0;
+        }
+        return true;
+    }
+    return false;
+}
+
+bool String::changeBuffer(unsigned int maxStrLen) {
+    char *newbuffer = static_cast<char *>(realloc(buffer, maxStrLen + 1));
+    if (!newbuffer) {
+        return false;
+    }
+    buffer = newbuffer;
+    capacity = maxStrLen;
+    return true;
+}
+
+String &String::copy(const char *cstr, unsigned int length) {
+    if (!reserve(length)) {
+        invalidate();
+        return *this;
+    }
+    len = length;
+    memmove(buffer, cstr, length);
+    buffer[len] = 0;
+    return *this;
+}
+
+void String::move(String &rhs) {
+    free(buffer);
+    buffer = rhs.buffer;
+    capacity = rhs.capacity;
+    len = rhs.len;
+    rhs.buffer = nullptr;
+    rhs.capacity = 0;
+    rhs.len = 0;
+}
+
+String &String::operator=(const String &rhs) {
+    if (this == &rhs) {
+        return *this;
+    }
+    if (rhs.buffer) {
+        copy(rhs.buffer, rhs.len);
+    } else {
+        invalidate();
+    }
+    return *this;
+}
+
+String &String::operator=(const char *cstr) {
+    if (cstr) {
+        copy(cstr, strlen(cstr));
+    } else {
+        invalidate();
+    }
+    return *this;
+}
+
+String &String::operator=(String &&rval) noexcept {
+    if (this != &rval) {
+        move(rval);
+    }
+    return *this;
+}
+
+bool String::concat(const char *cstr, unsigned int length) {
+    if (!cstr) {
+        return false;
+    }
+    if (length == 0) {
+        return true;
+    }
+    unsigned int newlen = len + length;
+    if (!reserve(newlen)) {
+        return false;
+    }
+    memmove(buffer + len, cstr, length);
+    len = newlen;
+    buffer[len] = 0;
+    return true;
+}
+
+bool String::concat(const String &str) {
+    if (&str == this) {
+        String tmp(str);
+        return concat(tmp.c_str(), tmp.len);
+    }
+    return concat(str.c_str(), str.len);
+}
+
+bool String::concat(const char *cstr) {
+    if (!cstr) {
+        return false;
+    }
+    return concat(cstr, strlen(cstr));
+}
+
+bool String::concat(char c) {
+    return concat(&c, 1);
+}
+
+bool String::concat(int num) {
+    return concat(String(num));
+}
+
+bool String::concat(unsigned int num) {
+    return concat(String(num));
+}
+
+bool String::concat(long num) {
+    return concat(String(num));
+}
+
+bool String::concat(unsigned long num) {
+    return concat(String(num));
+}
+
+bool String::concat(float num) {
+    return concat(String(num));
+}
+
+bool String::concat(double num) {
+    return concat(String(num));
+}
+
+int String::compareTo(const String &s) const {
+    return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String &s) const {
+    return len == s.len && compareTo(s) == 0;
+}
+
+bool String::equals(const char *cstr) const {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String &s) const {
+    return len == s.len && strcasecmp(c_str(), s.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+    return prefix.len <= len && startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const {
+    if (offset + prefix.len > len) {
+        return false;
+    }
+    return strncmp(c_str() + offset, prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    if (suffix.len > len) {
+        return false;
+    }
+    return strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return operator[](index);
+}
+
+void String::setCharAt(unsigned int index, char c) {
+    if (index < len) {
+        buffer[index] = c;
+    }
+}
+
+char String::operator[](unsigned int index) const {
+    if (index >= len) {
+        return 0;
+    }
+    return buffer[index];
+}
+
+char &String::operator[](unsigned int index) {
+    static char dummy_writable_char;
+    if (index >= len) {
+        dummy_writable_char = 0;
+        return dummy_writable_char;
+    }
+    return buffer[index];
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    if (fromIndex >= len) {
+        return -1;
+    }
+    const char *found = strchr(buffer + fromIndex, ch);
+    return found ? static_cast<int>(found - buffer) : -1;
+}
+
+int String::indexOf(const String &str, unsigned int fromIndex) const {
+    if (fromIndex >= len) {
+        return -1;
+    }
+    const char *found = strstr(buffer + fromIndex, str.c_str());
+    return found ? static_cast<int>(found - buffer) : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+    const char *found = len ? strrchr(buffer, ch) : nullptr;
+    return found ? static_cast<int>(found - buffer) : -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+    if (left > right) {
+        unsigned int temp = right;
+        right = left;
+        left = temp;
+    }
+    if (left >= len) {
+        return String();
+    }
+    if (right > len) {
+        right = len;
+    }
+    return String(buffer + left, right - left);
+}
+
+void String::replace(char find, char replace) {
+    for (unsigned int i = 0; i < len; ++i) {
+        if (buffer[i] == find) {
+            buffer[i] = replace;
+        }
+    }
+}
+
+void String::replace(const String &find, const String &replace) {
+    if (len == 0 || find.len == 0) {
+        return;
+    }
+    String result;
+    result.reserve(len);
+    const char *read = buffer;
+    const char *found;
+    while ((found = strstr(read, find.c_str())) != nullptr) {
+        result.concat(read, static_cast<unsigned int>(found - read));
+        result.concat(replace);
+        read = found + find.len;
+    }
+    if (read == buffer) {
+        return;
+    }
+    result.concat(read);
+    *this = static_cast<String &&>(result);
+}
+
+void String::remove(unsigned int index) {
+    remove(index, static_cast<unsigned int>(-1));
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= len || count == 0) {
+        return;
+    }
+    if (count > len - index) {
+        count = len - index;
+    }
+    memmove(buffer + index, buffer + index + count, len - index - count);
+    len -= count;
+    buffer[len] = 0;
+}
+
+void String::toLowerCase() {
+    for (unsigned int i = 0; i < len; ++i) {
+        buffer[i] = static_cast<char>(tolower(static_cast<unsigned char>(buffer[i])));
+    }
+}
+
+void String::toUpperCase() {
+    for (unsigned int i = 0; i < len; ++i) {
+        buffer[i] = static_cast<char>(toupper(static_cast<unsigned char>(buffer[i])));
+    }
+}
+
+void String::trim() {
+    if (len == 0) {
+        return;
+    }
+    char *begin = buffer;
+    while (isspace(static_cast<unsigned char>(*begin))) {
+        begin++;
+    }
+    char *end = buffer + len - 1;
+    while (end >= begin && isspace(static_cast<unsigned char>(*end))) {
+        end--;
+    }
+    len = static_cast<unsigned int>(end + 1 - begin);
+    if (begin > buffer) {
+        memmove(buffer, begin, len);
+    }
+    buffer[len] = 0;
+}
+
+long String::toInt() const {
+    return buffer ? atol(buffer) : 0;
+}
+
+float String::toFloat() const {
+    return static_cast<float>(toDouble());
+}
+
+double String::toDouble() const {
+    return buffer ? atof(buffer) : 0.0;
+}
+
+String operator+(const String &lhs, const String &rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String &lhs, const char *rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const char *lhs, const String &rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
+
+String operator+(const String &lhs, char rhs) {
+    String result(lhs);
+    result.concat(rhs);
+    return result;
+}
@@ -0,0 +1,177 @@
+#include "WiFi.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <sys/socket.h>
+
+WiFiClass WiFi;
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    (void)mode;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+    (void)wifioff;
+    (void)eraseap;
+    const bool was_connected = _status == WL_CONNECTED;
+    _status = WL_DISCONNECTED;
+    if (was_connected) {
+        fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+    }
+    return true;
+}
+
+bool WiFiClass::setAutoReconnect(bool autoReconnect) {
+    (void)autoReconnect;
+    return true;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event) {
+    _handlers.push_back({cbEvent, event});
+    return _handlers.size();
+}
+
+void WiFiClass::fire(arduino_event_id_t event, uint8_t reason) {
+    arduino_event_info_t info;
+    memset(&info, 0, sizeof(info));
+    if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+        const size_t length = std::min<size_t>(_ssid.length(), sizeof(info.wifi_sta_disconnected.ssid) - 1);
+        memcpy(info.wifi_sta_disconnected.ssid, _ssid.c_str(), length);
+        info.wifi_sta_disconnected.ssid_len = static_cast<uint8_t>(length);
+        memcpy(info.wifi_sta_disconnected.bssid, _bssid, sizeof(_bssid));
+        info.wifi_sta_disconnected.reason = reason;
+    }
+    for (const EventHandler &handler : _handlers) {
+        if (handler.event == ARDUINO_EVENT_MAX || handler.event == event) {
+            handler.callback(event, info);
+        }
+    }
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel,
+                             const uint8_t *bssid, bool connect) {
+    (void)passphrase;
+    (void)channel;
+    (void)bssid;
+    _ssid = ssid ? ssid : "";
+    if (_fail_connects < 0) {
+        const char *fail = getenv("WS_WIFI_FAIL_CONNECTS");
+        _fail_connects = fail ? std::max(atoi(fail), 0) : 0;
+    }
+    if (!connect) {
+        _status = WL_IDLE_STATUS;
+    } else if (_fail_connects > 0) {
+        --_fail_connects;
+        _status = WL_NO_SSID_AVAIL;
+        fire(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, WIFI_REASON_NO_AP_FOUND);
+    } else {
+        _status = WL_CONNECTED;
+        fire(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        fire(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    }
+    return _status;
+}
+
+wl_status_t WiFiClass::status() {
+    return _status;
+}
+
+bool WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+    (void)local_ip;
+    (void)gateway;
+    (void)subnet;
+    (void)dns1;
+    (void)dns2;
+    return true;
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool show_hidden) {
+    (void)show_hidden;
+    _scan_count = _ssid.length() > 0 ? 1 : 0;
+    return async ? WIFI_SCAN_RUNNING : _scan_count;
+}
+
+int16_t WiFiClass::scanComplete() {
+    return _scan_count;
+}
+
+void WiFiClass::scanDelete() {
+    _scan_count = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t networkItem) {
+    return networkItem == 0 ? _ssid : String();
+}
+
+String WiFiClass::SSID() const {
+    return _ssid;
+}
+
+int32_t WiFiClass::RSSI(uint8_t networkItem) {
+    (void)networkItem;
+    return -40;
+}
+
+int8_t WiFiClass::RSSI() {
+    return -40;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t networkItem) {
+    (void)networkItem;
+    return WIFI_AUTH_WPA2_PSK;
+}
+
+int32_t WiFiClass::channel() {
+    return 1;
+}
+
+uint8_t *WiFiClass::BSSID() {
+    return _bssid;
+}
+
+IPAddress WiFiClass::localIP() {
+    return IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+    return IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::subnetMask() {
+    return IPAddress(255, 0, 0, 0);
+}
+
+// The nameservers of the host, as a DHCP lease would hand them out
+IPAddress WiFiClass::dnsIP(uint8_t dns_no) {
+    FILE *resolv = fopen("/etc/resolv.conf", "r");
+    if (resolv) {
+        char line[128];
+        char address[64];
+        uint8_t index = 0;
+        IPAddress result;
+        while (fgets(line, sizeof(line), resolv)) {
+            if (sscanf(line, " nameserver %63s", address) == 1 && result.fromString(address) && index++ == dns_no) {
+                fclose(resolv);
+                return result;
+            }
+        }
+        fclose(resolv);
+    }
+    return IPAddress(127, 0, 0, 53);
+}
+
+int WiFiClass::hostByName(const char *hostname, IPAddress &result) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *info = nullptr;
+    if (getaddrinfo(hostname, nullptr, &hints, &info) != 0 || !info) {
+        return 0;
+    }
+    const struct sockaddr_in *addr = reinterpret_cast<const struct sockaddr_in *>(info->ai_addr);
+    result = IPAddress(static_cast<uint32_t>(addr->sin_addr.s_addr));
+    freeaddrinfo(info);
+    return 1;
+}
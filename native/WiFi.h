@@ -0,0 +1,133 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+#include <functional>
+#include <vector>
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+#define WIFI_AP WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+typedef enum {
+    WIFI_AUTH_OPEN = 0,
+    WIFI_AUTH_WEP,
+    WIFI_AUTH_WPA_PSK,
+    WIFI_AUTH_WPA2_PSK,
+    WIFI_AUTH_WPA_WPA2_PSK,
+} wifi_auth_mode_t;
+
+typedef enum {
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+// The disconnect reasons of esp_wifi_types.h the firmware looks at
+typedef enum {
+    WIFI_REASON_UNSPECIFIED = 1,
+    WIFI_REASON_AUTH_EXPIRE = 2,
+    WIFI_REASON_ASSOC_LEAVE = 8,
+    WIFI_REASON_BEACON_TIMEOUT = 200,
+    WIFI_REASON_NO_AP_FOUND = 201,
+    WIFI_REASON_AUTH_FAIL = 202,
+} wifi_err_reason_t;
+
+typedef struct {
+    uint8_t ssid[33];
+    uint8_t ssid_len;
+    uint8_t bssid[6];
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef size_t wifi_event_id_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+// The host is always "on the network": begin() connects immediately and the
+// station reports the loopback interface. The scan returns the configured SSID
+// so the firmware's diagnostics follow the same path as on a real access point.
+// Event handlers are called synchronously from begin() and disconnect(), with
+// the events a real station would send. WS_WIFI_FAIL_CONNECTS=N makes the
+// first N begin() calls fail with NO_AP_FOUND, to exercise the retries.
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode);
+    bool disconnect(bool wifioff = false, bool eraseap = false);
+    bool setAutoReconnect(bool autoReconnect);
+    wifi_event_id_t onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    wl_status_t status();
+    // A static configuration is accepted and ignored; 0.0.0.0 means DHCP
+    bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(),
+                IPAddress dns2 = IPAddress());
+
+    int16_t scanNetworks(bool async = false, bool show_hidden = false);
+    int16_t scanComplete();
+    void scanDelete();
+    String SSID(uint8_t networkItem);
+    String SSID() const;
+    int32_t RSSI(uint8_t networkItem);
+    int8_t RSSI();
+    wifi_auth_mode_t encryptionType(uint8_t networkItem);
+    int32_t channel();
+    uint8_t *BSSID();
+
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t dns_no = 0);
+
+    int hostByName(const char *hostname, IPAddress &result);
+
+private:
+    struct EventHandler {
+        WiFiEventFuncCb callback;
+        arduino_event_id_t event;
+    };
+
+    void fire(arduino_event_id_t event, uint8_t reason = 0);
+
+    std::vector<EventHandler> _handlers;
+    int _fail_connects = -1; // begin() calls left to fail, -1 until read
+    int16_t _scan_count = WIFI_SCAN_FAILED;
+    wl_status_t _status = WL_IDLE_STATUS;
+    String _ssid;
+    uint8_t _bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_WIFI_H
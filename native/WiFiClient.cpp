@@ -0,0 +1,226 @@
+#include "WiFiClient.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct WiFiClient::Socket {
+    int fd = -1;
+    uint8_t buffer[1460];
+    size_t pos = 0;
+    size_t len = 0;
+
+    ~Socket() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+WiFiClient::WiFiClient() {}
+
+WiFiClient::~WiFiClient() {}
+
+int WiFiClient::fd() const {
+    return _socket ? _socket->fd : -1;
+}
+
+int WiFiClient::connectAddress(const struct sockaddr *addr, unsigned int addrlen) {
+    int sockfd = socket(addr->sa_family, SOCK_STREAM, 0);
+    if (sockfd < 0) {
+        return 0;
+    }
+
+    int flags = fcntl(sockfd, F_GETFL, 0);
+    fcntl(sockfd, F_SETFL, flags | O_NONBLOCK);
+    int res = ::connect(sockfd, addr, addrlen);
+    if (res < 0 && errno != EINPROGRESS) {
+        ::close(sockfd);
+        return 0;
+    }
+    if (res < 0) {
+        struct pollfd pfd = {sockfd, POLLOUT, 0};
+        int soerr = 0;
+        socklen_t soerr_len = sizeof(soerr);
+        if (poll(&pfd, 1, static_cast<int>(_timeout)) <= 0 ||
+            getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &soerr, &soerr_len) < 0 || soerr != 0) {
+            ::close(sockfd);
+            return 0;
+        }
+    }
+    fcntl(sockfd, F_SETFL, flags);
+
+    int one = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    _socket = std::make_shared<Socket>();
+    _socket->fd = sockfd;
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+    // WS_HTTP_HOST (see HTTPClient.h) also covers connections the firmware
+    // opens itself to an address it resolved
+    const char *override_host = getenv("WS_HTTP_HOST");
+    if (override_host && *override_host) {
+        String target(override_host);
+        int colon = target.indexOf(':');
+        uint16_t target_port = colon >= 0 ? static_cast<uint16_t>(target.substring(colon + 1).toInt()) : port;
+        String target_host = colon >= 0 ? target.substring(0, colon) : target;
+        return WiFiClient::connect(target_host.c_str(), target_port);
+    }
+    stop();
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = static_cast<uint32_t>(ip);
+    return connectAddress(reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+    stop();
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *result = nullptr;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", port);
+    if (getaddrinfo(host, port_str, &hints, &result) != 0 || !result) {
+        return 0;
+    }
+    int connected_ok = connectAddress(result->ai_addr, result->ai_addrlen);
+    freeaddrinfo(result);
+    return connected_ok;
+}
+
+void WiFiClient::stop() {
+    _socket.reset();
+}
+
+int WiFiClient::fillBuffer(int timeout_ms) {
+    if (!_socket || _socket->fd < 0) {
+        return -1;
+    }
+    if (_socket->pos < _socket->len) {
+        return static_cast<int>(_socket->len - _socket->pos);
+    }
+    struct pollfd pfd = {_socket->fd, POLLIN, 0};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+    ssize_t n = recv(_socket->fd, _socket->buffer, sizeof(_socket->buffer), MSG_DONTWAIT);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        ::close(_socket->fd);
+        _socket->fd = -1;
+        return -1;
+    }
+    _socket->pos = 0;
+    _socket->len = static_cast<size_t>(n);
+    return static_cast<int>(n);
+}
+
+uint8_t WiFiClient::connected() {
+    if (!_socket) {
+        return 0;
+    }
+    if (_socket->pos < _socket->len) {
+        return 1;
+    }
+    if (_socket->fd < 0) {
+        return 0;
+    }
+    char probe;
+    ssize_t n = recv(_socket->fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        return 0;
+    }
+    return 1;
+}
+
+int WiFiClient::available() {
+    int n = fillBuffer(0);
+    return n > 0 ? n : 0;
+}
+
+int WiFiClient::read() {
+    if (fillBuffer(0) <= 0) {
+        return -1;
+    }
+    return _socket->buffer[_socket->pos++];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size) {
+    if (fillBuffer(0) <= 0) {
+        return -1;
+    }
+    size_t chunk = std::min(size, _socket->len - _socket->pos);
+    memcpy(buf, _socket->buffer + _socket->pos, chunk);
+    _socket->pos += chunk;
+    return static_cast<int>(chunk);
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length) {
+    size_t count = 0;
+    unsigned long start = millis();
+    while (count < length) {
+        unsigned long elapsed = millis() - start;
+        if (elapsed >= _timeout) {
+            break;
+        }
+        int ready = fillBuffer(static_cast<int>(_timeout - elapsed));
+        if (ready < 0) {
+            break;
+        }
+        if (ready == 0) {
+            continue;
+        }
+        size_t chunk = std::min(length - count, _socket->len - _socket->pos);
+        memcpy(buffer + count, _socket->buffer + _socket->pos, chunk);
+        _socket->pos += chunk;
+        count += chunk;
+    }
+    return count;
+}
+
+int WiFiClient::peek() {
+    if (fillBuffer(0) <= 0) {
+        return -1;
+    }
+    return _socket->buffer[_socket->pos];
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size) {
+    if (!_socket || _socket->fd < 0) {
+        return 0;
+    }
+    size_t sent = 0;
+    while (sent < size) {
+        ssize_t n = send(_socket->fd, buf + sent, size - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return sent;
+}
+
+void WiFiClient::flush() {
+    while (available() > 0) {
+        _socket->pos = _socket->len;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef NATIVE_WIFICLIENT_H
+#define NATIVE_WIFICLIENT_H
+
+#include <memory>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+// Plain TCP client on top of POSIX sockets, exposing the subset of the
+// arduino-esp32 WiFiClient API that HTTPClient and the firmware rely on.
+class WiFiClient : public Stream {
+public:
+    WiFiClient();
+    virtual ~WiFiClient();
+
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char *host, uint16_t port);
+    virtual uint8_t connected();
+    virtual void stop();
+
+    int available() override;
+    int read() override;
+    virtual int read(uint8_t *buf, size_t size);
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buf, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+    size_t readBytes(char *buffer, size_t length) override;
+    using Stream::readBytes;
+    int fd() const;
+
+    operator bool() { return connected(); }
+
+protected:
+    struct Socket;
+    std::shared_ptr<Socket> _socket;
+
+    int connectAddress(const struct sockaddr *addr, unsigned int addrlen);
+    int fillBuffer(int timeout_ms);
+};
+
+#endif // NATIVE_WIFICLIENT_H
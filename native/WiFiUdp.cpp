@@ -0,0 +1,124 @@
+#include "WiFiUdp.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+WiFiUDP::WiFiUDP() {}
+
+WiFiUDP::~WiFiUDP() {
+    stop();
+}
+
+bool WiFiUDP::ensureSocket() {
+    if (_fd < 0) {
+        _fd = socket(AF_INET, SOCK_DGRAM, 0);
+    }
+    return _fd >= 0;
+}
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    stop();
+    if (!ensureSocket()) {
+        return 0;
+    }
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(_fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) != 0) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    if (_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _tx_len = 0;
+    _rx_len = 0;
+    _rx_pos = 0;
+}
+
+int WiFiUDP::beginPacket(IPAddress ip, uint16_t port) {
+    if (!ensureSocket()) {
+        return 0;
+    }
+    _peer_ip = ip;
+    _peer_port = port;
+    _tx_len = 0;
+    return 1;
+}
+
+int WiFiUDP::endPacket() {
+    if (_fd < 0) {
+        return 0;
+    }
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_peer_port);
+    addr.sin_addr.s_addr = static_cast<uint32_t>(_peer_ip);
+    ssize_t sent = sendto(_fd, _tx, _tx_len, 0, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr));
+    _tx_len = 0;
+    return sent >= 0 ? 1 : 0;
+}
+
+size_t WiFiUDP::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiUDP::write(const uint8_t *buf, size_t size) {
+    size_t room = sizeof(_tx) - _tx_len;
+    size_t n = size < room ? size : room;
+    memcpy(_tx + _tx_len, buf, n);
+    _tx_len += n;
+    return n;
+}
+
+int WiFiUDP::parsePacket() {
+    if (_fd < 0) {
+        return 0;
+    }
+    struct sockaddr_in from = {};
+    socklen_t from_len = sizeof(from);
+    ssize_t n = recvfrom(_fd, _rx, sizeof(_rx), MSG_DONTWAIT, reinterpret_cast<struct sockaddr *>(&from), &from_len);
+    if (n <= 0) {
+        return 0;
+    }
+    _rx_len = static_cast<size_t>(n);
+    _rx_pos = 0;
+    _remote_ip = IPAddress(from.sin_addr.s_addr);
+    _remote_port = ntohs(from.sin_port);
+    return static_cast<int>(n);
+}
+
+int WiFiUDP::available() {
+    return static_cast<int>(_rx_len - _rx_pos);
+}
+
+int WiFiUDP::read() {
+    return _rx_pos < _rx_len ? _rx[_rx_pos++] : -1;
+}
+
+int WiFiUDP::read(uint8_t *buf, size_t size) {
+    size_t n = _rx_len - _rx_pos;
+    if (size < n) {
+        n = size;
+    }
+    memcpy(buf, _rx + _rx_pos, n);
+    _rx_pos += n;
+    return static_cast<int>(n);
+}
+
+IPAddress WiFiUDP::remoteIP() {
+    return _remote_ip;
+}
+
+uint16_t WiFiUDP::remotePort() {
+    return _remote_port;
+}
@@ -0,0 +1,45 @@
+#ifndef NATIVE_WIFIUDP_H
+#define NATIVE_WIFIUDP_H
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+// UDP socket with the packet API of the arduino-esp32 WiFiUDP: one outgoing
+// packet is assembled between beginPacket() and endPacket(), and
+// parsePacket() receives the next datagram without blocking.
+class WiFiUDP {
+public:
+    WiFiUDP();
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress ip, uint16_t port);
+    int endPacket();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *buf, size_t size);
+
+    int parsePacket();
+    int available();
+    int read();
+    int read(uint8_t *buf, size_t size);
+    IPAddress remoteIP();
+    uint16_t remotePort();
+
+private:
+    bool ensureSocket();
+
+    int _fd = -1;
+    IPAddress _peer_ip;
+    uint16_t _peer_port = 0;
+    uint8_t _tx[1460];
+    size_t _tx_len = 0;
+    uint8_t _rx[1460];
+    size_t _rx_len = 0;
+    size_t _rx_pos = 0;
+    IPAddress _remote_ip;
+    uint16_t _remote_port = 0;
+};
+
+#endif // NATIVE_WIFIUDP_H
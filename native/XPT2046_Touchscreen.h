@@ -0,0 +1,32 @@
+#ifndef NATIVE_XPT2046_TOUCHSCREEN_H
+#define NATIVE_XPT2046_TOUCHSCREEN_H
+
+#include "Arduino.h"
+#include "SPI.h"
+
+class TS_Point {
+public:
+    TS_Point() : x(0), y(0), z(0) {}
+    TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+    int16_t x, y, z;
+};
+
+// Touch controller that never reports a touch.
+class XPT2046_Touchscreen {
+public:
+    XPT2046_Touchscreen(uint8_t cspin, uint8_t tirq = 255) {
+        (void)cspin;
+        (void)tirq;
+    }
+
+    bool begin(SPIClass &wspi = SPI) {
+        (void)wspi;
+        return true;
+    }
+    void setRotation(uint8_t n) { (void)n; }
+    bool tirqTouched() { return false; }
+    bool touched() { return false; }
+    TS_Point getPoint() { return TS_Point(); }
+};
+
+#endif // NATIVE_XPT2046_TOUCHSCREEN_H
@@ -0,0 +1,93 @@
+#include "queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+struct NativeQueue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+// Waits until ready() holds; false when ticks_to_wait elapse first
+template <typename Ready>
+static bool wait_until(NativeQueue *queue, std::unique_lock<std::mutex> &lock, TickType_t ticks_to_wait,
+                       Ready ready) {
+    if (ticks_to_wait == portMAX_DELAY) {
+        queue->changed.wait(lock, ready);
+        return true;
+    }
+    return queue->changed.wait_for(lock, std::chrono::milliseconds(ticks_to_wait * portTICK_PERIOD_MS), ready);
+}
+
+extern "C" QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0) {
+        return nullptr;
+    }
+    NativeQueue *queue = new NativeQueue();
+    queue->storage = static_cast<uint8_t *>(malloc(static_cast<size_t>(length) * item_size));
+    if (!queue->storage && item_size > 0) {
+        delete queue;
+        return nullptr;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+extern "C" void vQueueDelete(QueueHandle_t queue) {
+    if (queue) {
+        free(queue->storage);
+        delete queue;
+    }
+}
+
+extern "C" BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks_to_wait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!wait_until(queue, lock, ticks_to_wait, [queue] { return queue->count < queue->length; })) {
+        return errQUEUE_FULL;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + static_cast<size_t>(tail) * queue->item_size, item, queue->item_size);
+    queue->count++;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+extern "C" BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->count == queue->length) {
+        queue->head = (queue->head + 1) % queue->length;
+        queue->count--;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->storage + static_cast<size_t>(tail) * queue->item_size, item, queue->item_size);
+    queue->count++;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+extern "C" BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks_to_wait) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!wait_until(queue, lock, ticks_to_wait, [queue] { return queue->count > 0; })) {
+        return errQUEUE_EMPTY;
+    }
+    memcpy(buffer, queue->storage + static_cast<size_t>(queue->head) * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+extern "C" UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    return queue->count;
+}
@@ -0,0 +1,136 @@
+#include "task.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <chrono>
+#include <thread>
+
+// FreeRTOS fills new stacks with this byte (tskSTACK_FILL_BYTE)
+static const uint8_t STACK_FILL_BYTE = 0xa5;
+
+struct NativeTask {
+    pthread_t thread;
+    uint8_t *stack;
+    size_t stack_size;
+    TaskFunction_t entry;
+    void *arg;
+    char name[16];
+};
+
+static thread_local NativeTask *current_task = nullptr;
+// Stands in for threads that were not started through the shims
+static thread_local NativeTask unmanaged_task = {};
+
+static void *task_main(void *param) {
+    NativeTask *task = static_cast<NativeTask *>(param);
+    current_task = task;
+    task->entry(task->arg);
+    return nullptr;
+}
+
+static NativeTask *start_task(TaskFunction_t entry, const char *name, size_t stack_size, void *arg, bool detached) {
+    NativeTask *task = new NativeTask();
+    task->entry = entry;
+    task->arg = arg;
+    snprintf(task->name, sizeof(task->name), "%s", name ? name : "");
+
+    // mmap keeps the stack out of the heap accounting of native_heap.cpp
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    void *stack = mmap(nullptr, stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack != MAP_FAILED) {
+        memset(stack, STACK_FILL_BYTE, stack_size);
+        if (pthread_attr_setstack(&attr, stack, stack_size) == 0) {
+            task->stack = static_cast<uint8_t *>(stack);
+            task->stack_size = stack_size;
+        } else {
+            munmap(stack, stack_size);
+        }
+    }
+    if (!task->stack) {
+        fprintf(stderr, "[native] could not set up a %zu byte stack for %s, high-water marks disabled\n",
+                stack_size, task->name);
+    }
+    if (detached) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    }
+
+    int result = pthread_create(&task->thread, &attr, task_main, task);
+    pthread_attr_destroy(&attr);
+    if (result != 0) {
+        if (task->stack) {
+            munmap(task->stack, task->stack_size);
+        }
+        delete task;
+        return nullptr;
+    }
+    return task;
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, const uint32_t stack_depth,
+                                              void *param, UBaseType_t priority, TaskHandle_t *created_task,
+                                              const BaseType_t core_id) {
+    (void)priority;
+    (void)core_id;
+    NativeTask *task = start_task(entry, name, static_cast<size_t>(stack_depth) * NATIVE_TASK_STACK_SCALE, param, true);
+    if (created_task) {
+        *created_task = task;
+    }
+    return task ? pdPASS : pdFAIL;
+}
+
+extern "C" BaseType_t xTaskCreate(TaskFunction_t entry, const char *name, const uint32_t stack_depth, void *param,
+                                  UBaseType_t priority, TaskHandle_t *created_task) {
+    return xTaskCreatePinnedToCore(entry, name, stack_depth, param, priority, created_task, tskNO_AFFINITY);
+}
+
+extern "C" void vTaskDelete(TaskHandle_t task) {
+    if (task && task != current_task) {
+        fprintf(stderr, "[native] vTaskDelete of another task is not supported\n");
+        return;
+    }
+    // The stack and the task record stay mapped: the thread is still running on them
+    pthread_exit(nullptr);
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current_task ? current_task : &unmanaged_task;
+}
+
+extern "C" const char *pcTaskGetName(TaskHandle_t task) {
+    NativeTask *t = static_cast<NativeTask *>(task ? task : xTaskGetCurrentTaskHandle());
+    return t->name;
+}
+
+extern "C" UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    NativeTask *t = static_cast<NativeTask *>(task ? task : xTaskGetCurrentTaskHandle());
+    if (!t->stack) {
+        return 0;
+    }
+    // The stack grows down, so untouched bytes are at the low end
+    size_t untouched = 0;
+    while (untouched < t->stack_size && t->stack[untouched] == STACK_FILL_BYTE) {
+        untouched++;
+    }
+    return static_cast<UBaseType_t>(untouched);
+}
+
+extern "C" void vTaskDelay(const TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+extern "C" BaseType_t xPortGetCoreID(void) {
+    return 1;
+}
+
+extern "C" void native_run_loop_task(TaskFunction_t entry, void *arg, size_t stack_size) {
+    NativeTask *task = start_task(entry, "loopTask", stack_size, arg, false);
+    if (!task) {
+        entry(arg);
+        return;
+    }
+    pthread_join(task->thread, nullptr);
+}
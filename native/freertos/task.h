@@ -0,0 +1,53 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include <stddef.h>
+
+#include "FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+// Size of the painted stack native_main runs setup()/loop() on. Host frames
+// are larger than Xtensa ones, so this is well above the 8 KB loopTask of
+// the ESP32 core; compare high-water marks between builds, not to the device.
+#ifndef NATIVE_LOOP_STACK_SIZE
+#define NATIVE_LOOP_STACK_SIZE (128U * 1024U)
+#endif
+
+// Tasks created with xTaskCreate* get their requested stack depth times this
+#ifndef NATIVE_TASK_STACK_SCALE
+#define NATIVE_TASK_STACK_SCALE 16
+#endif
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Tasks run as threads on pre-filled stacks; priority and core are ignored
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t entry, const char *name, const uint32_t stack_depth,
+                                   void *param, UBaseType_t priority, TaskHandle_t *created_task,
+                                   const BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t entry, const char *name, const uint32_t stack_depth, void *param,
+                       UBaseType_t priority, TaskHandle_t *created_task);
+// Only a task deleting itself (NULL) is supported
+void vTaskDelete(TaskHandle_t task);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char *pcTaskGetName(TaskHandle_t task);
+// Bytes of stack never touched by the task (StackType_t is a byte, as in ESP-IDF).
+// Threads not started through these shims (the process main thread) report 0.
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void vTaskDelay(const TickType_t ticks);
+BaseType_t xPortGetCoreID(void);
+
+// Runs entry(arg) as "loopTask" on a pre-filled stack of stack_size bytes and waits for it
+void native_run_loop_task(TaskFunction_t entry, void *arg, size_t stack_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_FREERTOS_TASK_H
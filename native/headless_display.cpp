@@ -0,0 +1,159 @@
+#include "headless_display.h"
+
+#include <stdio.h>
+
+#include "loop_profiler.h"
+
+static uint16_t framebuffer[HEADLESS_DISPLAY_WIDTH * HEADLESS_DISPLAY_HEIGHT];
+
+static HeadlessFrameStats frame_history[HEADLESS_FRAME_HISTORY];
+static size_t frame_history_count = 0;
+static size_t frame_history_next = 0;
+static HeadlessDisplayTotals totals;
+
+static lv_disp_t *headless_disp = nullptr;
+static uint32_t pending_areas = 0;
+static uint32_t pending_pixels = 0;
+static bool trace_frames = false;
+
+static void headless_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
+    ProfileScope profile(STAGE_DISP_FLUSH);
+    const int32_t w = area->x2 - area->x1 + 1;
+    for (int32_t y = area->y1; y <= area->y2; ++y) {
+        if (y >= 0 && y < HEADLESS_DISPLAY_HEIGHT) {
+            for (int32_t x = area->x1; x <= area->x2; ++x) {
+                if (x >= 0 && x < HEADLESS_DISPLAY_WIDTH) {
+                    framebuffer[y * HEADLESS_DISPLAY_WIDTH + x] = color_p[(y - area->y1) * w + (x - area->x1)].full;
+                }
+            }
+        }
+    }
+
+    pending_areas++;
+    pending_pixels += static_cast<uint32_t>(w) * static_cast<uint32_t>(area->y2 - area->y1 + 1);
+    lv_disp_flush_ready(disp);
+}
+
+static const HeadlessFrameStats *record_frame(uint32_t render_us) {
+    if (pending_areas == 0) {
+        return nullptr;
+    }
+
+    HeadlessFrameStats &frame = frame_history[frame_history_next];
+    frame.frame = ++totals.frames;
+    frame.areas = pending_areas;
+    frame.pixels = pending_pixels;
+    frame.render_us = render_us;
+    frame_history_next = (frame_history_next + 1) % HEADLESS_FRAME_HISTORY;
+    if (frame_history_count < HEADLESS_FRAME_HISTORY) {
+        frame_history_count++;
+    }
+
+    totals.areas += pending_areas;
+    totals.pixels += pending_pixels;
+    totals.render_us += render_us;
+    if (render_us > totals.max_render_us) {
+        totals.max_render_us = render_us;
+    }
+    pending_areas = 0;
+    pending_pixels = 0;
+
+    if (trace_frames) {
+        Serial.printf("[frame %u] areas=%u px=%u render=%uus\n", frame.frame, frame.areas, frame.pixels,
+                      frame.render_us);
+    }
+    return &frame;
+}
+
+static void headless_refr_timer(lv_timer_t *timer) {
+    const unsigned long start = micros();
+    _lv_disp_refr_timer(timer);
+    record_frame(static_cast<uint32_t>(micros() - start));
+}
+
+void headless_display_init(lv_disp_drv_t *drv) {
+    drv->hor_res = HEADLESS_DISPLAY_WIDTH;
+    drv->ver_res = HEADLESS_DISPLAY_HEIGHT;
+    drv->flush_cb = headless_disp_flush;
+
+    const char *trace_env = getenv("WS_HEADLESS_TRACE");
+    trace_frames = trace_env && *trace_env && *trace_env != '0';
+}
+
+void headless_display_attach(lv_disp_t *disp) {
+    headless_disp = disp;
+    lv_timer_t *refr_timer = _lv_disp_get_refr_timer(disp);
+    if (refr_timer) {
+        refr_timer->timer_cb = headless_refr_timer;
+    }
+}
+
+const HeadlessFrameStats *headless_display_refresh_now() {
+    const unsigned long start = micros();
+    lv_refr_now(headless_disp);
+    return record_frame(static_cast<uint32_t>(micros() - start));
+}
+
+const HeadlessFrameStats *headless_display_last_frame() {
+    if (frame_history_count == 0) {
+        return nullptr;
+    }
+    return &frame_history[(frame_history_next + HEADLESS_FRAME_HISTORY - 1) % HEADLESS_FRAME_HISTORY];
+}
+
+size_t headless_display_history(HeadlessFrameStats *out, size_t max_frames) {
+    size_t count = frame_history_count < max_frames ? frame_history_count : max_frames;
+    size_t start = (frame_history_next + HEADLESS_FRAME_HISTORY - count) % HEADLESS_FRAME_HISTORY;
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = frame_history[(start + i) % HEADLESS_FRAME_HISTORY];
+    }
+    return count;
+}
+
+HeadlessDisplayTotals headless_display_totals() {
+    return totals;
+}
+
+void headless_display_reset_stats() {
+    frame_history_count = 0;
+    frame_history_next = 0;
+    totals = HeadlessDisplayTotals();
+    pending_areas = 0;
+    pending_pixels = 0;
+}
+
+void headless_display_print_stats(Print &out) {
+    out.println("Headless display statistics:");
+    out.printf("  Frames: %u\n", totals.frames);
+    if (totals.frames == 0) {
+        return;
+    }
+    out.printf("  Areas: %llu (%.1f per frame)\n", static_cast<unsigned long long>(totals.areas),
+               static_cast<double>(totals.areas) / totals.frames);
+    out.printf("  Pixels: %llu (%.0f per frame)\n", static_cast<unsigned long long>(totals.pixels),
+               static_cast<double>(totals.pixels) / totals.frames);
+    out.printf("  Render time: avg %.0f us, max %u us\n", static_cast<double>(totals.render_us) / totals.frames,
+               totals.max_render_us);
+}
+
+const uint16_t *headless_display_framebuffer() {
+    return framebuffer;
+}
+
+bool headless_display_write_ppm(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "P6\n%d %d\n255\n", HEADLESS_DISPLAY_WIDTH, HEADLESS_DISPLAY_HEIGHT);
+    for (size_t i = 0; i < sizeof(framebuffer) / sizeof(framebuffer[0]); ++i) {
+        const uint16_t px = framebuffer[i];
+        const uint8_t rgb[3] = {
+            static_cast<uint8_t>(((px >> 11) & 0x1F) * 255 / 31),
+            static_cast<uint8_t>(((px >> 5) & 0x3F) * 255 / 63),
+            static_cast<uint8_t>((px & 0x1F) * 255 / 31),
+        };
+        fwrite(rgb, 1, sizeof(rgb), fp);
+    }
+    return fclose(fp) == 0;
+}
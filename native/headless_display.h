@@ -0,0 +1,48 @@
+#ifndef HEADLESS_DISPLAY_H
+#define HEADLESS_DISPLAY_H
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+// In-memory 240x320 RGB565 display driver for LVGL, used instead of
+// my_disp_flush in the native build. Every refresh that redraws something is
+// recorded as a frame: number of flushed areas, pixels pushed and the time
+// LVGL spent rendering and flushing it.
+
+#define HEADLESS_DISPLAY_WIDTH 240
+#define HEADLESS_DISPLAY_HEIGHT 320
+#define HEADLESS_FRAME_HISTORY 64
+
+struct HeadlessFrameStats {
+    uint32_t frame;
+    uint32_t areas;
+    uint32_t pixels;
+    uint32_t render_us;
+};
+
+struct HeadlessDisplayTotals {
+    uint32_t frames;
+    uint64_t areas;
+    uint64_t pixels;
+    uint64_t render_us;
+    uint32_t max_render_us;
+};
+
+// Sets the flush callback on a driver before lv_disp_drv_register()
+void headless_display_init(lv_disp_drv_t *drv);
+// Wraps the display refresh timer so every refresh is timed; call after registering
+void headless_display_attach(lv_disp_t *disp);
+
+// Forces an immediate refresh and returns the recorded frame (nullptr if nothing was redrawn)
+const HeadlessFrameStats *headless_display_refresh_now();
+
+const HeadlessFrameStats *headless_display_last_frame();
+size_t headless_display_history(HeadlessFrameStats *out, size_t max_frames);
+HeadlessDisplayTotals headless_display_totals();
+void headless_display_reset_stats();
+void headless_display_print_stats(Print &out);
+
+const uint16_t *headless_display_framebuffer();
+bool headless_display_write_ppm(const char *path);
+
+#endif // HEADLESS_DISPLAY_H
@@ -0,0 +1,134 @@
+#include "native_heap.h"
+#include "alloc_trace.h"
+
+#include <malloc.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <new>
+
+static std::atomic<size_t> heap_in_use(0);
+static std::atomic<size_t> heap_peak(0);
+static std::atomic<size_t> heap_max_in_use(0);
+static std::atomic<uint32_t> heap_allocations(0);
+static std::atomic<uint32_t> heap_frees(0);
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+}
+
+static void raise_to(std::atomic<size_t> &mark, size_t now) {
+    size_t current = mark.load();
+    while (now > current && !mark.compare_exchange_weak(current, now)) {
+    }
+}
+
+static void note_alloc(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    size_t size = malloc_usable_size(ptr);
+    size_t now = heap_in_use.fetch_add(size) + size;
+    raise_to(heap_peak, now);
+    raise_to(heap_max_in_use, now);
+    heap_allocations++;
+#if ALLOC_TRACE
+    alloc_trace_note_alloc(size);
+#endif
+}
+
+static void note_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    size_t size = malloc_usable_size(ptr);
+    size_t current = heap_in_use.load();
+    // Blocks allocated by libc internals (unwrapped) may be released here
+    heap_in_use.fetch_sub(size < current ? size : current);
+    heap_frees++;
+#if ALLOC_TRACE
+    alloc_trace_note_free(size);
+#endif
+}
+
+extern "C" void *__wrap_malloc(size_t size) {
+    void *ptr = __real_malloc(size);
+    note_alloc(ptr);
+    return ptr;
+}
+
+extern "C" void *__wrap_calloc(size_t nmemb, size_t size) {
+    void *ptr = __real_calloc(nmemb, size);
+    note_alloc(ptr);
+    return ptr;
+}
+
+extern "C" void *__wrap_realloc(void *ptr, size_t size) {
+    note_free(ptr);
+    void *result = __real_realloc(ptr, size);
+    if (!result && ptr && size > 0) {
+        // The original block is still allocated
+        note_alloc(ptr);
+        return result;
+    }
+    note_alloc(result);
+    return result;
+}
+
+extern "C" void __wrap_free(void *ptr) {
+    note_free(ptr);
+    __real_free(ptr);
+}
+
+void *operator new(size_t size) {
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+NativeHeapStats native_heap_stats() {
+    NativeHeapStats stats;
+    stats.in_use = heap_in_use.load();
+    stats.peak = heap_peak.load();
+    stats.max_in_use = heap_max_in_use.load();
+    stats.allocations = heap_allocations.load();
+    stats.frees = heap_frees.load();
+    return stats;
+}
+
+void native_heap_reset_peak() {
+    heap_peak.store(heap_in_use.load());
+}
@@ -0,0 +1,23 @@
+#ifndef NATIVE_HEAP_H
+#define NATIVE_HEAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Heap accounting for the host build. malloc/calloc/realloc/free are wrapped
+// at link time (-Wl,--wrap=...) and operator new/delete are routed through
+// them, so every allocation made by the firmware, ArduinoJson and the String
+// shim is counted. Sizes are the usable block sizes reported by glibc.
+struct NativeHeapStats {
+    size_t in_use;
+    size_t peak;        // since the last native_heap_reset_peak()
+    size_t max_in_use;  // since start, like ESP.getMinFreeHeap()
+    uint32_t allocations;
+    uint32_t frees;
+};
+
+NativeHeapStats native_heap_stats();
+// Restart peak tracking from the current usage
+void native_heap_reset_peak();
+
+#endif // NATIVE_HEAP_H
@@ -0,0 +1,40 @@
+// Entry point for the host build: runs the firmware's setup()/loop() like the
+// Arduino core does on the ESP32. WS_LOOP_ITERATIONS bounds the number of
+// loop() passes so the binary can be run under a profiler and exit cleanly.
+// The loop profile is printed on exit; with the headless display, a render
+// summary is printed as well and WS_HEADLESS_PPM=<path> saves the final
+// framebuffer as an image.
+// Like the ESP32 loopTask, setup()/loop() run on their own pre-filled stack
+// so uxTaskGetStackHighWaterMark() reports real numbers.
+
+#include <Arduino.h>
+#include "loop_profiler.h"
+#if HEADLESS_DISPLAY
+#include "headless_display.h"
+#endif
+
+static void loop_task(void *param) {
+    const long iterations = *static_cast<long *>(param);
+    setup();
+    for (long i = 0; iterations <= 0 || i < iterations; ++i) {
+        loop();
+    }
+}
+
+int main() {
+    const char *iterations_env = getenv("WS_LOOP_ITERATIONS");
+    long iterations = iterations_env ? atol(iterations_env) : 0;
+
+    native_run_loop_task(loop_task, &iterations, NATIVE_LOOP_STACK_SIZE);
+
+    profiler_print(Serial);
+#if HEADLESS_DISPLAY
+    headless_display_print_stats(Serial);
+    const char *ppm_path = getenv("WS_HEADLESS_PPM");
+    if (ppm_path && *ppm_path && !headless_display_write_ppm(ppm_path)) {
+        Serial.printf("Failed to write %s\n", ppm_path);
+    }
+#endif
+    Serial.flush();
+    return 0;
+}
@@ -0,0 +1,305 @@
+// Host implementation of TlsClient (include/tls_client.h) on OpenSSL, capped
+// at TLS 1.2 like the mbedtls build on the ESP32.
+
+#include "tls_client.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+struct TlsClient::Tls {
+    // Created by the first secure connection and kept, like the mbedtls
+    // configuration on the ESP32
+    SSL_CTX *ctx = nullptr;
+    SSL *ssl = nullptr;
+    // Outlives the connections: the session to resume next time
+    SSL_SESSION *session = nullptr;
+};
+
+TlsClient::TlsClient() : _tls(new Tls) {
+    _server_name[0] = '\0';
+}
+
+static void free_ctx(SSL_CTX *&ctx) {
+    if (ctx) {
+        SSL_CTX_free(ctx);
+        ctx = nullptr;
+    }
+}
+
+TlsClient::~TlsClient() {
+    stop();
+    forgetSession();
+    free_ctx(_tls->ctx);
+    delete _tls;
+}
+
+void TlsClient::setSecure(bool secure) {
+    stop();
+    _secure = secure;
+}
+
+void TlsClient::setServerName(const char *name) {
+    strncpy(_server_name, name ? name : "", sizeof(_server_name) - 1);
+    _server_name[sizeof(_server_name) - 1] = '\0';
+}
+
+// A different CA means a new context, and a session saved under the old one
+// must not be resumed: resuming skips verifying the server
+void TlsClient::setCACert(const char *pem) {
+    if (pem == _ca_pem && !_insecure) {
+        return;
+    }
+    stop();
+    free_ctx(_tls->ctx);
+    forgetSession();
+    _ca_pem = pem;
+    _insecure = false;
+}
+
+void TlsClient::setInsecure() {
+    if (_insecure) {
+        return;
+    }
+    stop();
+    free_ctx(_tls->ctx);
+    forgetSession();
+    _ca_pem = nullptr;
+    _insecure = true;
+}
+
+void TlsClient::forgetSession() {
+    if (_tls->session) {
+        SSL_SESSION_free(_tls->session);
+        _tls->session = nullptr;
+    }
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+    if (!WiFiClient::connect(ip, port)) {
+        return 0;
+    }
+    return !_secure || startTls(_server_name) ? 1 : 0;
+}
+
+int TlsClient::connect(const char *host, uint16_t port) {
+    if (!WiFiClient::connect(host, port)) {
+        return 0;
+    }
+    return !_secure || startTls(_server_name[0] != '\0' ? _server_name : host) ? 1 : 0;
+}
+
+static bool load_ca(SSL_CTX *ctx, const char *pem) {
+    BIO *bio = BIO_new_mem_buf(pem, -1);
+    if (!bio) {
+        return false;
+    }
+    X509_STORE *store = SSL_CTX_get_cert_store(ctx);
+    int loaded = 0;
+    while (X509 *cert = PEM_read_bio_X509(bio, nullptr, nullptr, nullptr)) {
+        loaded += X509_STORE_add_cert(store, cert);
+        X509_free(cert);
+    }
+    ERR_clear_error();
+    BIO_free(bio);
+    return loaded > 0;
+}
+
+bool TlsClient::startTls(const char *host) {
+    Tls &tls = *_tls;
+    const uint32_t started = millis();
+    _resumed = false;
+    if (!_ca_pem && !_insecure) {
+        Serial.printf("TLS: no CA certificate for %s, not connecting unverified\n", host);
+        WiFiClient::stop();
+        return false;
+    }
+
+    if (!tls.ctx) {
+        tls.ctx = SSL_CTX_new(TLS_client_method());
+        if (!tls.ctx) {
+            WiFiClient::stop();
+            return false;
+        }
+        SSL_CTX_set_max_proto_version(tls.ctx, TLS1_2_VERSION);
+        if (_ca_pem) {
+            if (!load_ca(tls.ctx, _ca_pem)) {
+                Serial.println("TLS setup failed: no certificate in the CA PEM");
+                free_ctx(tls.ctx);
+                WiFiClient::stop();
+                return false;
+            }
+            SSL_CTX_set_verify(tls.ctx, SSL_VERIFY_PEER, nullptr);
+        } else {
+            SSL_CTX_set_verify(tls.ctx, SSL_VERIFY_NONE, nullptr);
+        }
+    }
+
+    tls.ssl = SSL_new(tls.ctx);
+    SSL_set_fd(tls.ssl, WiFiClient::fd());
+    if (host && *host) {
+        SSL_set_tlsext_host_name(tls.ssl, host);
+        if (_ca_pem) {
+            SSL_set1_host(tls.ssl, host);
+        }
+    }
+    if (tls.session) {
+        SSL_set_session(tls.ssl, tls.session);
+    }
+
+    // The socket of the base class is blocking; bound the handshake with a
+    // receive timeout instead
+    struct timeval timeout = {TLS_HANDSHAKE_TIMEOUT_MS / 1000, (TLS_HANDSHAKE_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(WiFiClient::fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    const int ret = SSL_connect(tls.ssl);
+    timeout = {0, 0};
+    setsockopt(WiFiClient::fd(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (ret != 1) {
+        char error[128];
+        ERR_error_string_n(ERR_get_error(), error, sizeof(error));
+        Serial.printf("TLS handshake with %s failed: %s\n", host, error);
+        // The saved session may be what the server rejected
+        forgetSession();
+        stop();
+        return false;
+    }
+
+    _resumed = SSL_session_reused(tls.ssl) == 1;
+    forgetSession();
+    tls.session = SSL_get1_session(tls.ssl);
+    _handshake_ms = millis() - started;
+    return true;
+}
+
+void TlsClient::stopTls() {
+    Tls &tls = *_tls;
+    // The context is kept for the next connection
+    if (tls.ssl) {
+        SSL_free(tls.ssl);
+        tls.ssl = nullptr;
+    }
+}
+
+void TlsClient::stop() {
+    if (_tls->ssl && SSL_is_init_finished(_tls->ssl) && WiFiClient::connected()) {
+        SSL_shutdown(_tls->ssl);
+    }
+    stopTls();
+    WiFiClient::stop();
+}
+
+uint8_t TlsClient::connected() {
+    if (!_secure) {
+        return WiFiClient::connected();
+    }
+    if (!_tls->ssl) {
+        return 0;
+    }
+    if (SSL_pending(_tls->ssl) > 0) {
+        return 1;
+    }
+    // Peek at the socket without consuming TLS records
+    char probe;
+    ssize_t n = recv(WiFiClient::fd(), &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n > 0 || (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) ? 1 : 0;
+}
+
+int TlsClient::available() {
+    if (!_secure) {
+        return WiFiClient::available();
+    }
+    if (!_tls->ssl) {
+        return 0;
+    }
+    int pending = SSL_pending(_tls->ssl);
+    if (pending > 0) {
+        return pending;
+    }
+    struct pollfd pfd = {WiFiClient::fd(), POLLIN, 0};
+    if (poll(&pfd, 1, 0) <= 0) {
+        return 0;
+    }
+    // Process the record that arrived without consuming application data
+    char probe;
+    int ret = SSL_peek(_tls->ssl, &probe, 1);
+    if (ret <= 0) {
+        int error = SSL_get_error(_tls->ssl, ret);
+        if (error != SSL_ERROR_WANT_READ && error != SSL_ERROR_WANT_WRITE) {
+            stop();
+        }
+        return 0;
+    }
+    return SSL_pending(_tls->ssl);
+}
+
+int TlsClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int TlsClient::read(uint8_t *buf, size_t size) {
+    if (!_secure) {
+        return WiFiClient::read(buf, size);
+    }
+    if (available() <= 0) {
+        return -1;
+    }
+    int ret = SSL_read(_tls->ssl, buf, static_cast<int>(size));
+    if (ret <= 0) {
+        stop();
+        return -1;
+    }
+    return ret;
+}
+
+size_t TlsClient::readBytes(char *buffer, size_t length) {
+    if (!_secure) {
+        return WiFiClient::readBytes(buffer, length);
+    }
+    size_t count = 0;
+    const uint32_t started = millis();
+    while (count < length && millis() - started < _timeout) {
+        int got = read(reinterpret_cast<uint8_t *>(buffer) + count, length - count);
+        if (got > 0) {
+            count += got;
+        } else if (!_tls->ssl) {
+            break;
+        } else {
+            struct pollfd pfd = {WiFiClient::fd(), POLLIN, 0};
+            poll(&pfd, 1, 1);
+        }
+    }
+    return count;
+}
+
+int TlsClient::peek() {
+    if (!_secure) {
+        return WiFiClient::peek();
+    }
+    uint8_t c;
+    return available() > 0 && SSL_peek(_tls->ssl, &c, 1) == 1 ? c : -1;
+}
+
+size_t TlsClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t TlsClient::write(const uint8_t *buf, size_t size) {
+    if (!_secure) {
+        return WiFiClient::write(buf, size);
+    }
+    if (!_tls->ssl || size == 0) {
+        return 0;
+    }
+    int ret = SSL_write(_tls->ssl, buf, static_cast<int>(size));
+    return ret > 0 ? static_cast<size_t>(ret) : 0;
+}
+
+void TlsClient::flush() {
+    if (!_secure) {
+        WiFiClient::flush();
+    }
+}
@@ -0,0 +1,190 @@
+#include "alloc_trace.h"
+
+#if ALLOC_TRACE
+
+#if !NATIVE_BUILD
+#include <esp_heap_caps.h>
+#endif
+
+struct PhaseStats {
+    uint32_t calls;
+    uint32_t calls_allocating;   // calls that allocated at least once
+    uint32_t last_allocs;
+    uint32_t max_allocs;
+    uint64_t allocs;
+    uint64_t frees;
+    uint64_t bytes_allocated;
+    int64_t net_bytes;           // allocated minus freed, grows on a leak
+};
+
+// Counts are kept per task: the loop task and the network task each claim a
+// slot when they open their first scope. Allocations by other tasks
+// (WiFi/LwIP) are not counted, so they do not end up in loop phases.
+static const int MAX_TRACED_TASKS = 2;
+
+struct TracedTask {
+    TaskHandle_t task;
+    AllocCounts totals;
+};
+
+static TracedTask traced_tasks[MAX_TRACED_TASKS];
+static PhaseStats phase_stats[ALLOC_PHASE_COUNT];
+
+static const char *PHASE_NAMES[ALLOC_PHASE_COUNT] = {
+    "loop",
+    "transliterate_to_ascii",
+    "update_ui",
+    "fetch_weather",
+    "fetch_forecast",
+    "sd_config_load",
+};
+
+static AllocCounts *current_task_totals() {
+    const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (auto &traced : traced_tasks) {
+        if (traced.task == task) {
+            return &traced.totals;
+        }
+    }
+    return nullptr;
+}
+
+void alloc_trace_note_alloc(size_t size) {
+    AllocCounts *totals = current_task_totals();
+    if (totals) {
+        totals->allocs++;
+        totals->bytes_allocated += size;
+    }
+}
+
+void alloc_trace_note_free(size_t size) {
+    AllocCounts *totals = current_task_totals();
+    if (totals) {
+        totals->frees++;
+        totals->bytes_freed += size;
+    }
+}
+
+AllocCounts alloc_trace_totals() {
+    AllocCounts *totals = current_task_totals();
+    if (totals) {
+        return *totals;
+    }
+    for (auto &traced : traced_tasks) {
+        if (!traced.task) {
+            traced.task = xTaskGetCurrentTaskHandle();
+            return traced.totals;
+        }
+    }
+    return AllocCounts();
+}
+
+void alloc_trace_record(AllocPhase phase, const AllocCounts &before) {
+    if (phase >= ALLOC_PHASE_COUNT) {
+        return;
+    }
+    const AllocCounts *totals = current_task_totals();
+    if (!totals) {
+        return;
+    }
+    PhaseStats &stats = phase_stats[phase];
+    const uint32_t allocs = totals->allocs - before.allocs;
+    const uint32_t frees = totals->frees - before.frees;
+    const uint32_t bytes_allocated = totals->bytes_allocated - before.bytes_allocated;
+    const uint32_t bytes_freed = totals->bytes_freed - before.bytes_freed;
+
+    stats.calls++;
+    if (allocs > 0) {
+        stats.calls_allocating++;
+    }
+    stats.last_allocs = allocs;
+    if (allocs > stats.max_allocs) {
+        stats.max_allocs = allocs;
+    }
+    stats.allocs += allocs;
+    stats.frees += frees;
+    stats.bytes_allocated += bytes_allocated;
+    stats.net_bytes += (int64_t)bytes_allocated - (int64_t)bytes_freed;
+}
+
+void alloc_trace_print(Print &out) {
+    out.println("=========================================");
+    out.println("Allocations per call (loop and network task, inclusive)");
+    out.println("=========================================");
+    out.printf("%-23s %7s %7s %7s %6s %6s %9s %9s\n", "phase", "calls", "w/alloc", "avg", "last", "max",
+               "avg bytes", "net bytes");
+    for (int i = 0; i < ALLOC_PHASE_COUNT; ++i) {
+        const PhaseStats &stats = phase_stats[i];
+        if (stats.calls == 0) {
+            out.printf("%-23s %7s\n", PHASE_NAMES[i], "-");
+            continue;
+        }
+        out.printf("%-23s %7lu %7lu %7.1f %6lu %6lu %9.0f %9lld\n", PHASE_NAMES[i], (unsigned long)stats.calls,
+                   (unsigned long)stats.calls_allocating, (double)stats.allocs / stats.calls,
+                   (unsigned long)stats.last_allocs, (unsigned long)stats.max_allocs,
+                   (double)stats.bytes_allocated / stats.calls, (long long)stats.net_bytes);
+    }
+    for (const auto &traced : traced_tasks) {
+        if (traced.task) {
+            out.printf("Total %-10s %lu allocs, %lu frees, %lu bytes allocated\n", pcTaskGetName(traced.task),
+                       (unsigned long)traced.totals.allocs, (unsigned long)traced.totals.frees,
+                       (unsigned long)traced.totals.bytes_allocated);
+        }
+    }
+    out.println("=========================================\n");
+}
+
+void alloc_trace_reset() {
+    for (auto &stats : phase_stats) {
+        stats = PhaseStats();
+    }
+}
+
+#if !NATIVE_BUILD
+// Linker wrappers for the device; the host build counts through native_heap.cpp
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    void *ptr = __real_malloc(size);
+    if (ptr) {
+        alloc_trace_note_alloc(heap_caps_get_allocated_size(ptr));
+    }
+    return ptr;
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    void *ptr = __real_calloc(nmemb, size);
+    if (ptr) {
+        alloc_trace_note_alloc(heap_caps_get_allocated_size(ptr));
+    }
+    return ptr;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    const size_t old_size = ptr ? heap_caps_get_allocated_size(ptr) : 0;
+    void *result = __real_realloc(ptr, size);
+    if (result || size == 0) {
+        if (ptr) {
+            alloc_trace_note_free(old_size);
+        }
+        if (result) {
+            alloc_trace_note_alloc(heap_caps_get_allocated_size(result));
+        }
+    }
+    return result;
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) {
+        alloc_trace_note_free(heap_caps_get_allocated_size(ptr));
+    }
+    __real_free(ptr);
+}
+}
+#endif
+
+#endif // ALLOC_TRACE
@@ -0,0 +1,35 @@
+#include "api_http_client.h"
+
+// Same as HTTPClient::sendHeader(), with API_ACCEPT_ENCODING in place of the
+// library's Accept-Encoding line
+bool ApiHttpClient::sendRequestHeader(const char *type) {
+    if (!connected()) {
+        return false;
+    }
+    String header = String(type) + " " + (_uri.length() ? _uri : String("/")) + " HTTP/1.";
+    header += _useHTTP10 ? "0" : "1";
+    header += "\r\nHost: ";
+    header += _host;
+    if (_port != 80 && _port != 443) {
+        header += ':';
+        header += String(static_cast<unsigned int>(_port));
+    }
+    header += "\r\nUser-Agent: ";
+    header += _userAgent;
+    header += "\r\nConnection: ";
+    header += _reuse ? "keep-alive" : "close";
+    header += "\r\nAccept-Encoding: " API_ACCEPT_ENCODING "\r\n";
+    header += _headers;
+    header += "\r\n";
+    return _client->write(reinterpret_cast<const uint8_t *>(header.c_str()), header.length()) == header.length();
+}
+
+int ApiHttpClient::GET() {
+    if (!connect()) {
+        return returnError(HTTPC_ERROR_CONNECTION_REFUSED);
+    }
+    if (!sendRequestHeader("GET")) {
+        return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
+    }
+    return returnError(handleHeaderResponse());
+}
@@ -0,0 +1,205 @@
+#include "dns_cache.h"
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+static const uint16_t DNS_PORT = 53;
+static const uint16_t DNS_TYPE_A = 1;
+static const uint16_t DNS_CLASS_IN = 1;
+static const size_t DNS_PACKET_SIZE = 512;
+
+static char cached_host[64];
+static IPAddress cached_address;
+static bool cached = false;
+static uint32_t resolved_at_ms = 0;
+static uint32_t ttl_ms = 0;
+
+// Static so the packet does not count against the network task stack
+static uint8_t packet[DNS_PACKET_SIZE];
+
+static uint16_t read_u16(const uint8_t *p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint32_t read_u32(const uint8_t *p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// Offset just past the (possibly compressed) name at pos, or 0 if malformed
+static size_t skip_name(const uint8_t *data, size_t length, size_t pos) {
+    while (pos < length) {
+        const uint8_t label = data[pos];
+        if ((label & 0xC0) == 0xC0) {
+            return pos + 2 <= length ? pos + 2 : 0;
+        }
+        if (label == 0) {
+            return pos + 1;
+        }
+        pos += 1 + label;
+    }
+    return 0;
+}
+
+static size_t build_query(const char *host, uint16_t id) {
+    size_t pos = 0;
+    packet[pos++] = id >> 8;
+    packet[pos++] = id & 0xFF;
+    packet[pos++] = 0x01;       // recursion desired
+    packet[pos++] = 0x00;
+    packet[pos++] = 0x00;       // one question
+    packet[pos++] = 0x01;
+    memset(packet + pos, 0, 6); // no answer, authority or additional records
+    pos += 6;
+
+    const char *label = host;
+    while (*label != '\0') {
+        const char *dot = strchr(label, '.');
+        const size_t label_length = dot ? static_cast<size_t>(dot - label) : strlen(label);
+        if (label_length == 0 || label_length > 63 || pos + label_length + 6 > DNS_PACKET_SIZE) {
+            return 0;
+        }
+        packet[pos++] = static_cast<uint8_t>(label_length);
+        memcpy(packet + pos, label, label_length);
+        pos += label_length;
+        label += label_length + (dot ? 1 : 0);
+    }
+    packet[pos++] = 0;
+    packet[pos++] = DNS_TYPE_A >> 8;
+    packet[pos++] = DNS_TYPE_A & 0xFF;
+    packet[pos++] = DNS_CLASS_IN >> 8;
+    packet[pos++] = DNS_CLASS_IN & 0xFF;
+    return pos;
+}
+
+// First A record of the answer; the TTL is the lowest along a CNAME chain
+static bool parse_answer(size_t length, uint16_t id, IPAddress &address, uint32_t &ttl_s) {
+    if (length < 12 || read_u16(packet) != id || (packet[2] & 0x80) == 0 || (packet[3] & 0x0F) != 0) {
+        return false;
+    }
+    const uint16_t questions = read_u16(packet + 4);
+    const uint16_t answers = read_u16(packet + 6);
+    size_t pos = 12;
+    for (uint16_t i = 0; i < questions; ++i) {
+        pos = skip_name(packet, length, pos);
+        if (pos == 0 || pos + 4 > length) {
+            return false;
+        }
+        pos += 4;
+    }
+    uint32_t lowest_ttl = UINT32_MAX;
+    for (uint16_t i = 0; i < answers; ++i) {
+        pos = skip_name(packet, length, pos);
+        if (pos == 0 || pos + 10 > length) {
+            return false;
+        }
+        const uint16_t type = read_u16(packet + pos);
+        const uint16_t record_class = read_u16(packet + pos + 2);
+        const uint32_t record_ttl = read_u32(packet + pos + 4);
+        const uint16_t data_length = read_u16(packet + pos + 8);
+        pos += 10;
+        if (pos + data_length > length) {
+            return false;
+        }
+        lowest_ttl = min(lowest_ttl, record_ttl);
+        if (type == DNS_TYPE_A && record_class == DNS_CLASS_IN && data_length == 4) {
+            address = IPAddress(packet[pos], packet[pos + 1], packet[pos + 2], packet[pos + 3]);
+            ttl_s = lowest_ttl;
+            return true;
+        }
+        pos += data_length;
+    }
+    return false;
+}
+
+static bool query_nameserver(const char *host, IPAddress &address, uint32_t &ttl_s) {
+    const IPAddress nameserver = WiFi.dnsIP();
+    if (static_cast<uint32_t>(nameserver) == 0) {
+        return false;
+    }
+    const uint16_t id = static_cast<uint16_t>(random(0, 0x10000));
+    const size_t query_length = build_query(host, id);
+    if (query_length == 0) {
+        return false;
+    }
+
+    WiFiUDP udp;
+    if (!udp.beginPacket(nameserver, DNS_PORT)) {
+        return false;
+    }
+    udp.write(packet, query_length);
+    if (!udp.endPacket()) {
+        udp.stop();
+        return false;
+    }
+
+    bool found = false;
+    const uint32_t started = millis();
+    while (millis() - started < DNS_CACHE_TIMEOUT_MS) {
+        const int size = udp.parsePacket();
+        if (size <= 0) {
+            delay(5);
+            continue;
+        }
+        const int length = udp.read(packet, sizeof(packet));
+        if (udp.remoteIP() == nameserver && parse_answer(length > 0 ? length : 0, id, address, ttl_s)) {
+            found = true;
+            break;
+        }
+    }
+    udp.stop();
+    return found;
+}
+
+static bool lookup(const char *host) {
+    const uint32_t started = millis();
+    IPAddress address;
+    uint32_t ttl_s = 0;
+    const char *source = "DNS";
+    if (!query_nameserver(host, address, ttl_s)) {
+        if (!WiFi.hostByName(host, address)) {
+            Serial.printf("DNS lookup for %s failed\n", host);
+            return false;
+        }
+        ttl_s = DNS_CACHE_DEFAULT_TTL_S;
+        source = "resolver";
+    }
+    ttl_s = constrain(ttl_s, static_cast<uint32_t>(DNS_CACHE_MIN_TTL_S), static_cast<uint32_t>(DNS_CACHE_MAX_TTL_S));
+
+    if (host != cached_host) {
+        strncpy(cached_host, host, sizeof(cached_host) - 1);
+        cached_host[sizeof(cached_host) - 1] = '\0';
+    }
+    cached_address = address;
+    cached = true;
+    resolved_at_ms = millis();
+    ttl_ms = ttl_s * 1000;
+    Serial.printf("Resolved %s to %s in %lu ms (%s, TTL %lu s)\n", host, address.toString().c_str(),
+                  (unsigned long)(resolved_at_ms - started), source, (unsigned long)ttl_s);
+    return true;
+}
+
+bool dns_cache_resolve(const char *host, IPAddress &address) {
+    if (address.fromString(host)) {
+        return true;
+    }
+    if (!cached || strcmp(host, cached_host) != 0) {
+        if (!lookup(host)) {
+            return false;
+        }
+    }
+    address = cached_address;
+    return true;
+}
+
+void dns_cache_invalidate() {
+    cached = false;
+}
+
+void dns_cache_refresh() {
+    // A failed lookup keeps the old address, the best guess left, and is
+    // tried again after the next refresh
+    if (cached && millis() - resolved_at_ms >= ttl_ms) {
+        lookup(cached_host);
+    }
+}
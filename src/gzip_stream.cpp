@@ -0,0 +1,539 @@
+#include "gzip_stream.h"
+
+// Bytes inflated per fill(). Must stay below GZIP_WINDOW_SIZE so a fill never
+// overwrites window bytes the reader has not taken yet.
+static const size_t GZIP_FILL_BYTES = 256;
+
+static const uint8_t GZIP_FLAG_HCRC = 0x02;
+static const uint8_t GZIP_FLAG_EXTRA = 0x04;
+static const uint8_t GZIP_FLAG_NAME = 0x08;
+static const uint8_t GZIP_FLAG_COMMENT = 0x10;
+static const uint8_t GZIP_FLAG_RESERVED = 0xE0;
+
+// RFC 1951 length and distance codes: base value and extra bits
+static const uint16_t LENGTH_BASE[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DISTANCE_BASE[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                           33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order in which the code length code lengths are sent
+static const uint8_t CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// CRC-32 (the gzip polynomial) four bits at a time: a 64 byte table instead of 1 KB
+static const uint32_t CRC_NIBBLE[16] = {0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+                                        0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+                                        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+enum InflateState {
+    INFLATE_HEADER,
+    INFLATE_BLOCK,
+    INFLATE_STORED,
+    INFLATE_CODES,
+    INFLATE_MATCH,
+    INFLATE_TRAILER,
+    INFLATE_DONE,
+    INFLATE_FAILED,
+};
+
+// Canonical Huffman code: number of codes of each length, then the symbols
+// ordered by code
+struct Huffman {
+    uint16_t counts[16];
+    uint16_t symbols[288];
+};
+
+// Decoder state, kept next to the window rather than in the stream object so
+// the stream stays small on the network task stack
+struct GzipStream::Inflater {
+    Stream *source;
+    InflateState state;
+    bool final_block;
+    uint32_t bits;
+    int bit_count;
+    uint8_t input[64];
+    size_t input_pos;
+    size_t input_len;
+    Huffman literals;
+    Huffman distances;
+    uint8_t code_lengths[288 + 32];
+    uint16_t stored_left;
+    uint16_t match_length;
+    uint16_t match_distance;
+    uint32_t crc;
+    const char *error;
+
+    int next_byte();
+    int get_bits(int count);
+    void align();
+    int decode(const Huffman &code);
+    bool read_header();
+    bool read_tables();
+    void fixed_tables();
+    bool fail(const char *text);
+};
+
+int GzipStream::Inflater::next_byte() {
+    if (input_pos >= input_len) {
+        input_len = source->readBytes(reinterpret_cast<char *>(input), sizeof(input));
+        input_pos = 0;
+        if (input_len == 0) {
+            return -1;
+        }
+    }
+    return input[input_pos++];
+}
+
+// Next count bits, least significant first; -1 when the input ran out
+int GzipStream::Inflater::get_bits(int count) {
+    while (bit_count < count) {
+        const int byte = next_byte();
+        if (byte < 0) {
+            return -1;
+        }
+        bits |= static_cast<uint32_t>(byte) << bit_count;
+        bit_count += 8;
+    }
+    const int value = static_cast<int>(bits & ((1u << count) - 1));
+    bits >>= count;
+    bit_count -= count;
+    return value;
+}
+
+void GzipStream::Inflater::align() {
+    bits >>= bit_count & 7;
+    bit_count -= bit_count & 7;
+}
+
+bool GzipStream::Inflater::fail(const char *text) {
+    error = text;
+    return false;
+}
+
+// One symbol, read a bit at a time and compared against the first code of
+// each length; -1 when the input ran out, -2 for a code not in the table
+int GzipStream::Inflater::decode(const Huffman &code) {
+    int value = 0;
+    int first = 0;
+    int index = 0;
+    for (int length = 1; length < 16; ++length) {
+        const int bit = get_bits(1);
+        if (bit < 0) {
+            return -1;
+        }
+        value |= bit;
+        const int count = code.counts[length];
+        if (value - count < first) {
+            return code.symbols[index + (value - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        value <<= 1;
+    }
+    return -2;
+}
+
+// Fills the code from a list of code lengths; false when the lengths
+// describe more codes than there are bit patterns
+static bool build_huffman(Huffman &code, const uint8_t *lengths, int count) {
+    memset(code.counts, 0, sizeof(code.counts));
+    for (int symbol = 0; symbol < count; ++symbol) {
+        code.counts[lengths[symbol]]++;
+    }
+    int left = 1;
+    for (int length = 1; length < 16; ++length) {
+        left = (left << 1) - code.counts[length];
+        if (left < 0) {
+            return false;
+        }
+    }
+    uint16_t offsets[16];
+    offsets[1] = 0;
+    for (int length = 1; length < 15; ++length) {
+        offsets[length + 1] = offsets[length] + code.counts[length];
+    }
+    for (int symbol = 0; symbol < count; ++symbol) {
+        if (lengths[symbol] != 0) {
+            code.symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+    }
+    return true;
+}
+
+bool GzipStream::Inflater::read_header() {
+    uint8_t header[10];
+    for (uint8_t &byte : header) {
+        const int value = get_bits(8);
+        if (value < 0) {
+            return fail("truncated header");
+        }
+        byte = static_cast<uint8_t>(value);
+    }
+    if (header[0] != 0x1F || header[1] != 0x8B || header[2] != 8 || (header[3] & GZIP_FLAG_RESERVED) != 0) {
+        return fail("not gzip/deflate data");
+    }
+    const uint8_t flags = header[3];
+    if (flags & GZIP_FLAG_EXTRA) {
+        const int low = get_bits(8);
+        const int high = get_bits(8);
+        if (high < 0) {
+            return fail("truncated header");
+        }
+        for (int left = low | (high << 8); left > 0; --left) {
+            if (get_bits(8) < 0) {
+                return fail("truncated header");
+            }
+        }
+    }
+    // File name and comment are zero terminated
+    for (uint8_t flag : {GZIP_FLAG_NAME, GZIP_FLAG_COMMENT}) {
+        if (flags & flag) {
+            int value;
+            while ((value = get_bits(8)) > 0) {
+            }
+            if (value < 0) {
+                return fail("truncated header");
+            }
+        }
+    }
+    if ((flags & GZIP_FLAG_HCRC) && get_bits(16) < 0) {
+        return fail("truncated header");
+    }
+    return true;
+}
+
+void GzipStream::Inflater::fixed_tables() {
+    int symbol = 0;
+    for (; symbol < 144; ++symbol) {
+        code_lengths[symbol] = 8;
+    }
+    for (; symbol < 256; ++symbol) {
+        code_lengths[symbol] = 9;
+    }
+    for (; symbol < 280; ++symbol) {
+        code_lengths[symbol] = 7;
+    }
+    for (; symbol < 288; ++symbol) {
+        code_lengths[symbol] = 8;
+    }
+    build_huffman(literals, code_lengths, 288);
+    memset(code_lengths, 5, 30);
+    build_huffman(distances, code_lengths, 30);
+}
+
+// Dynamic block header: the code lengths of both codes, themselves Huffman
+// coded with a code whose lengths come first
+bool GzipStream::Inflater::read_tables() {
+    const int literal_count = get_bits(5) + 257;
+    const int distance_count = get_bits(5) + 1;
+    const int length_code_count = get_bits(4) + 4;
+    if (length_code_count < 4 || distance_count < 1 || literal_count < 257) {
+        return fail("truncated block header");
+    }
+    if (literal_count > 286 || distance_count > 30) {
+        return fail("bad code counts");
+    }
+
+    memset(code_lengths, 0, 19);
+    for (int i = 0; i < length_code_count; ++i) {
+        const int length = get_bits(3);
+        if (length < 0) {
+            return fail("truncated block header");
+        }
+        code_lengths[CODE_LENGTH_ORDER[i]] = static_cast<uint8_t>(length);
+    }
+    // The literal code is not needed yet and holds the code length code
+    if (!build_huffman(literals, code_lengths, 19)) {
+        return fail("bad code length code");
+    }
+
+    const int total = literal_count + distance_count;
+    int index = 0;
+    while (index < total) {
+        const int symbol = decode(literals);
+        if (symbol < 0) {
+            return fail(symbol == -1 ? "truncated block header" : "bad code length code");
+        }
+        if (symbol < 16) {
+            code_lengths[index++] = static_cast<uint8_t>(symbol);
+            continue;
+        }
+        // 16 repeats the previous length 3-6 times, 17 and 18 repeat zero
+        // 3-10 and 11-138 times
+        uint8_t length = 0;
+        int extra;
+        int repeat;
+        if (symbol == 16) {
+            if (index == 0) {
+                return fail("repeat without a length");
+            }
+            length = code_lengths[index - 1];
+            extra = get_bits(2);
+            repeat = 3 + extra;
+        } else if (symbol == 17) {
+            extra = get_bits(3);
+            repeat = 3 + extra;
+        } else {
+            extra = get_bits(7);
+            repeat = 11 + extra;
+        }
+        if (extra < 0) {
+            return fail("truncated block header");
+        }
+        if (index + repeat > total) {
+            return fail("too many code lengths");
+        }
+        memset(code_lengths + index, length, repeat);
+        index += repeat;
+    }
+    if (code_lengths[256] == 0) {
+        return fail("no end of block code");
+    }
+    if (!build_huffman(literals, code_lengths, literal_count) ||
+        !build_huffman(distances, code_lengths + literal_count, distance_count)) {
+        return fail("bad literal or distance code");
+    }
+    return true;
+}
+
+// The window and the decoder state exist once, for the life of the program:
+// a window taken from the heap per response would put a large contiguous
+// block back into every refresh. Set while a stream is using them.
+static uint8_t gzip_window[GZIP_WINDOW_SIZE];
+static bool gzip_state_in_use = false;
+
+GzipStream::GzipStream(Stream &source) : _source(source) {}
+
+GzipStream::~GzipStream() {
+    if (_inflater) {
+        gzip_state_in_use = false;
+    }
+}
+
+void GzipStream::fail(const char *error) {
+    _error = error;
+    if (_inflater) {
+        _inflater->state = INFLATE_FAILED;
+    }
+}
+
+// Appends one inflated byte to the window
+void GzipStream::put(uint8_t c) {
+    gzip_window[_out_total & (GZIP_WINDOW_SIZE - 1)] = c;
+    ++_out_total;
+    uint32_t crc = _inflater->crc ^ c;
+    crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    _inflater->crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+}
+
+// Inflates up to GZIP_FILL_BYTES more bytes; only called once the reader has
+// taken everything inflated before
+bool GzipStream::fill() {
+    if (!_inflater) {
+        if (_error) {
+            return false;
+        }
+        static Inflater inflater;
+        if (gzip_state_in_use) {
+            _error = "another GzipStream is inflating";
+            return false;
+        }
+        gzip_state_in_use = true;
+        _inflater = &inflater;
+        memset(_inflater, 0, sizeof(Inflater));
+        _inflater->source = &_source;
+        _inflater->state = INFLATE_HEADER;
+        _inflater->crc = 0xFFFFFFFF;
+    }
+    Inflater &z = *_inflater;
+    const size_t target = _out_total + GZIP_FILL_BYTES;
+
+    while (_out_total < target && z.state != INFLATE_DONE && z.state != INFLATE_FAILED) {
+        switch (z.state) {
+        case INFLATE_HEADER:
+            if (z.read_header()) {
+                z.state = INFLATE_BLOCK;
+            } else {
+                fail(z.error);
+            }
+            break;
+
+        case INFLATE_BLOCK: {
+            const int final_block = z.get_bits(1);
+            const int type = z.get_bits(2);
+            if (type < 0) {
+                fail("truncated block header");
+                break;
+            }
+            z.final_block = final_block == 1;
+            if (type == 0) {
+                z.align();
+                const int length = z.get_bits(16);
+                const int complement = z.get_bits(16);
+                if (complement < 0) {
+                    fail("truncated block header");
+                } else if (length != (~complement & 0xFFFF)) {
+                    fail("bad stored block length");
+                } else {
+                    z.stored_left = static_cast<uint16_t>(length);
+                    z.state = INFLATE_STORED;
+                }
+            } else if (type == 1) {
+                z.fixed_tables();
+                z.state = INFLATE_CODES;
+            } else if (type == 2) {
+                if (z.read_tables()) {
+                    z.state = INFLATE_CODES;
+                } else {
+                    fail(z.error);
+                }
+            } else {
+                fail("bad block type");
+            }
+            break;
+        }
+
+        case INFLATE_STORED:
+            if (z.stored_left == 0) {
+                z.state = z.final_block ? INFLATE_TRAILER : INFLATE_BLOCK;
+            } else {
+                const int byte = z.get_bits(8);
+                if (byte < 0) {
+                    fail("truncated data");
+                } else {
+                    put(static_cast<uint8_t>(byte));
+                    --z.stored_left;
+                }
+            }
+            break;
+
+        case INFLATE_CODES: {
+            int symbol = z.decode(z.literals);
+            if (symbol < 0) {
+                fail(symbol == -1 ? "truncated data" : "bad literal code");
+            } else if (symbol < 256) {
+                put(static_cast<uint8_t>(symbol));
+            } else if (symbol == 256) {
+                z.state = z.final_block ? INFLATE_TRAILER : INFLATE_BLOCK;
+            } else if ((symbol -= 257) >= 29) {
+                fail("bad length code");
+            } else {
+                const int length_extra = z.get_bits(LENGTH_EXTRA[symbol]);
+                const int distance_symbol = z.decode(z.distances);
+                if (length_extra < 0 || distance_symbol == -1) {
+                    fail("truncated data");
+                    break;
+                }
+                if (distance_symbol < 0 || distance_symbol >= 30) {
+                    fail("bad distance code");
+                    break;
+                }
+                const int distance_extra = z.get_bits(DISTANCE_EXTRA[distance_symbol]);
+                if (distance_extra < 0) {
+                    fail("truncated data");
+                    break;
+                }
+                const uint16_t distance = DISTANCE_BASE[distance_symbol] + distance_extra;
+                if (distance > _out_total) {
+                    fail("distance too far back");
+                    break;
+                }
+                z.match_length = LENGTH_BASE[symbol] + length_extra;
+                z.match_distance = distance;
+                z.state = INFLATE_MATCH;
+            }
+            break;
+        }
+
+        case INFLATE_MATCH:
+            // Byte by byte: the match may overlap the bytes it produces
+            while (z.match_length > 0 && _out_total < target) {
+                put(gzip_window[(_out_total - z.match_distance) & (GZIP_WINDOW_SIZE - 1)]);
+                --z.match_length;
+            }
+            if (z.match_length == 0 && z.state == INFLATE_MATCH) {
+                z.state = INFLATE_CODES;
+            }
+            break;
+
+        case INFLATE_TRAILER: {
+            z.align();
+            const int crc_low = z.get_bits(16);
+            const int crc_high = z.get_bits(16);
+            const int size_low = z.get_bits(16);
+            const int size_high = z.get_bits(16);
+            if (size_high < 0) {
+                fail("truncated trailer");
+                break;
+            }
+            const uint32_t crc = static_cast<uint32_t>(crc_low) | (static_cast<uint32_t>(crc_high) << 16);
+            const uint32_t size = static_cast<uint32_t>(size_low) | (static_cast<uint32_t>(size_high) << 16);
+            if (crc != (z.crc ^ 0xFFFFFFFF)) {
+                fail("CRC mismatch");
+            } else if (size != static_cast<uint32_t>(_out_total)) {
+                fail("length mismatch");
+            } else {
+                z.state = INFLATE_DONE;
+                _ended = true;
+            }
+            break;
+        }
+
+        case INFLATE_DONE:
+        case INFLATE_FAILED:
+            break;
+        }
+    }
+    return _out_total > _read_total;
+}
+
+int GzipStream::available() {
+    const size_t pending = _out_total - _read_total;
+    if (pending > 0) {
+        return static_cast<int>(pending);
+    }
+    // Compressed bytes waiting do not tell how many inflated ones follow
+    return !_ended && !_error && _source.available() > 0 ? 1 : 0;
+}
+
+int GzipStream::read() {
+    if (_read_total == _out_total && !fill()) {
+        return -1;
+    }
+    return gzip_window[_read_total++ & (GZIP_WINDOW_SIZE - 1)];
+}
+
+int GzipStream::peek() {
+    if (_read_total == _out_total && !fill()) {
+        return -1;
+    }
+    return gzip_window[_read_total & (GZIP_WINDOW_SIZE - 1)];
+}
+
+size_t GzipStream::readBytes(char *buffer, size_t length) {
+    size_t copied = 0;
+    while (copied < length) {
+        if (_read_total == _out_total && !fill()) {
+            break;
+        }
+        const size_t offset = _read_total & (GZIP_WINDOW_SIZE - 1);
+        // Up to the end of the inflated bytes or of the window, whichever is first
+        size_t n = min(length - copied, _out_total - _read_total);
+        n = min(n, GZIP_WINDOW_SIZE - offset);
+        memcpy(buffer + copied, gzip_window + offset, n);
+        _read_total += n;
+        copied += n;
+    }
+    return copied;
+}
+
+bool GzipStream::finish() {
+    _read_total = _out_total;
+    while (fill()) {
+        _read_total = _out_total;
+    }
+    return _ended && !_error;
+}
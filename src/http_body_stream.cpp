@@ -0,0 +1,153 @@
+#include "http_body_stream.h"
+
+HttpBodyStream::HttpBodyStream(Stream &source, bool chunked, int content_length)
+    : _source(source), _chunked(chunked), _remaining(chunked ? 0 : content_length) {
+    if (!chunked && content_length == 0) {
+        _done = true;
+    }
+}
+
+bool HttpBodyStream::read_source(char &c) {
+    return _source.readBytes(&c, 1) == 1;
+}
+
+// Parses "<hex size>[;extensions]\r\n", after the CRLF ending the previous chunk
+bool HttpBodyStream::read_chunk_size() {
+    char c;
+    if (!_first_chunk) {
+        if (!read_source(c) || c != '\r' || !read_source(c) || c != '\n') {
+            return false;
+        }
+    }
+    _first_chunk = false;
+
+    long size = 0;
+    int digits = 0;
+    bool in_extension = false;
+    while (read_source(c)) {
+        if (c == '\n') {
+            if (digits == 0) {
+                return false;
+            }
+            _remaining = size;
+            return true;
+        }
+        if (in_extension || c == '\r') {
+            continue;
+        }
+        if (c == ';') {
+            in_extension = true;
+            continue;
+        }
+        int value;
+        if (c >= '0' && c <= '9') {
+            value = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            value = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            value = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        if (++digits > 7) {
+            return false;
+        }
+        size = size * 16 + value;
+    }
+    return false;
+}
+
+bool HttpBodyStream::fill() {
+    if (_done) {
+        return false;
+    }
+    if (_chunked && _remaining == 0) {
+        if (!read_chunk_size()) {
+            _failed = true;
+            _done = true;
+            return false;
+        }
+        if (_remaining == 0) {
+            // Last chunk: skip trailer lines up to the empty one
+            String line;
+            do {
+                line = _source.readStringUntil('\n');
+                line.trim();
+            } while (line.length() > 0);
+            _done = true;
+            return false;
+        }
+    }
+
+    size_t want = sizeof(_buffer);
+    if (_remaining >= 0 && static_cast<size_t>(_remaining) < want) {
+        want = static_cast<size_t>(_remaining);
+    }
+    size_t got = _source.readBytes(_buffer, want);
+    if (got == 0) {
+        // Without a length the body ends when the server closes the connection
+        _failed = _remaining >= 0;
+        _done = true;
+        return false;
+    }
+    _pos = 0;
+    _len = got;
+    _bytes_read += got;
+    if (_remaining > 0) {
+        _remaining -= static_cast<long>(got);
+        if (!_chunked && _remaining == 0) {
+            _done = true;
+        }
+    }
+    return true;
+}
+
+int HttpBodyStream::available() {
+    if (_pos < _len) {
+        return static_cast<int>(_len - _pos);
+    }
+    if (_done) {
+        return 0;
+    }
+    int pending = _source.available();
+    if (_remaining > 0 && pending > _remaining) {
+        pending = static_cast<int>(_remaining);
+    }
+    return pending;
+}
+
+int HttpBodyStream::read() {
+    if (_pos >= _len && !fill()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(_buffer[_pos++]);
+}
+
+int HttpBodyStream::peek() {
+    if (_pos >= _len && !fill()) {
+        return -1;
+    }
+    return static_cast<uint8_t>(_buffer[_pos]);
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length) {
+    size_t copied = 0;
+    while (copied < length) {
+        if (_pos >= _len && !fill()) {
+            break;
+        }
+        size_t n = min(length - copied, _len - _pos);
+        memcpy(buffer + copied, _buffer + _pos, n);
+        _pos += n;
+        copied += n;
+    }
+    return copied;
+}
+
+bool HttpBodyStream::finish() {
+    _pos = _len;
+    while (fill()) {
+        _pos = _len;
+    }
+    return !_failed;
+}
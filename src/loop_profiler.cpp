@@ -0,0 +1,118 @@
+#include "loop_profiler.h"
+
+#include <algorithm>
+
+struct StageRing {
+    uint32_t samples[PROFILER_RING_SIZE];
+    uint32_t count;
+    uint32_t next;
+    uint32_t last_us;
+    uint32_t max_us;
+};
+
+static StageRing stage_rings[STAGE_COUNT];
+// The network task records the fetch stages while the loop task reads the
+// rings for the Serial dump and the overlay
+static portMUX_TYPE rings_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *STAGE_NAMES[STAGE_COUNT] = {
+    "loop",
+    "lv_timer_handler",
+    "update_time_display",
+    "fetch_weather",
+    "fetch_forecast",
+    "deserializeJson",
+    "update_ui",
+    "my_disp_flush",
+};
+
+void profiler_record(ProfileStage stage, uint32_t duration_us) {
+    if (stage >= STAGE_COUNT) {
+        return;
+    }
+    portENTER_CRITICAL(&rings_mux);
+    StageRing &ring = stage_rings[stage];
+    ring.samples[ring.next] = duration_us;
+    ring.next = (ring.next + 1) % PROFILER_RING_SIZE;
+    ring.count++;
+    ring.last_us = duration_us;
+    if (duration_us > ring.max_us) {
+        ring.max_us = duration_us;
+    }
+    portEXIT_CRITICAL(&rings_mux);
+}
+
+bool profiler_summary(ProfileStage stage, ProfileSummary &summary) {
+    if (stage >= STAGE_COUNT) {
+        return false;
+    }
+    // Copied under the lock, sorted outside it
+    StageRing ring;
+    portENTER_CRITICAL(&rings_mux);
+    ring = stage_rings[stage];
+    portEXIT_CRITICAL(&rings_mux);
+    if (ring.count == 0) {
+        return false;
+    }
+    const uint32_t window = ring.count < PROFILER_RING_SIZE ? ring.count : PROFILER_RING_SIZE;
+
+    uint32_t sorted[PROFILER_RING_SIZE];
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < window; ++i) {
+        sorted[i] = ring.samples[i];
+        total += ring.samples[i];
+    }
+    std::sort(sorted, sorted + window);
+
+    summary.count = ring.count;
+    summary.window = window;
+    summary.last_us = ring.last_us;
+    summary.min_us = sorted[0];
+    summary.avg_us = static_cast<uint32_t>(total / window);
+    summary.p99_us = sorted[std::min(window - 1, (window * 99) / 100)];
+    summary.max_us = ring.max_us;
+    return true;
+}
+
+uint32_t profiler_last_us(ProfileStage stage) {
+    if (stage >= STAGE_COUNT) {
+        return 0;
+    }
+    portENTER_CRITICAL(&rings_mux);
+    const uint32_t last_us = stage_rings[stage].last_us;
+    portEXIT_CRITICAL(&rings_mux);
+    return last_us;
+}
+
+const char *profiler_stage_name(ProfileStage stage) {
+    return stage < STAGE_COUNT ? STAGE_NAMES[stage] : "?";
+}
+
+void profiler_print(Print &out) {
+    out.println("=========================================");
+    out.printf("Loop profile (last %d samples per stage, us)\n", PROFILER_RING_SIZE);
+    out.println("=========================================");
+    out.printf("%-20s %8s %9s %9s %9s %9s\n", "stage", "count", "min", "avg", "p99", "max");
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        ProfileSummary summary;
+        if (!profiler_summary(static_cast<ProfileStage>(i), summary)) {
+            out.printf("%-20s %8s\n", STAGE_NAMES[i], "-");
+            continue;
+        }
+        out.printf("%-20s %8lu %9lu %9lu %9lu %9lu\n", STAGE_NAMES[i], (unsigned long)summary.count,
+                   (unsigned long)summary.min_us, (unsigned long)summary.avg_us, (unsigned long)summary.p99_us,
+                   (unsigned long)summary.max_us);
+    }
+    out.println("=========================================\n");
+}
+
+void profiler_reset() {
+    portENTER_CRITICAL(&rings_mux);
+    for (auto &ring : stage_rings) {
+        ring.count = 0;
+        ring.next = 0;
+        ring.last_us = 0;
+        ring.max_us = 0;
+    }
+    portEXIT_CRITICAL(&rings_mux);
+}
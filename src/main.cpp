@@ -5,69 +5,31 @@
 #include <lvgl.h>
 #include <TFT_eSPI.h>
 #include <time.h>
-#include <float.h>
-#include <limits.h>
 #include <algorithm>
 #include <XPT2046_Touchscreen.h>
 #include "config.h"
 #include "sd_config.h"
-#include "weather_images.h"
+#include "weather_parse.h"
+#include "alloc_trace.h"
+#include "loop_profiler.h"
+#include "mem_diag.h"
+#include "perf_overlay.h"
+#include "weather_ui.h"
+#include "http_body_stream.h"
+#include "gzip_stream.h"
+#include "dns_cache.h"
+#include "tls_client.h"
+#include "api_ca_cert.h"
+#include "api_http_client.h"
+#include "refresh_scheduler.h"
+#include "wifi_link.h"
+#if HEADLESS_DISPLAY
+#include "headless_display.h"
+#endif
 
 // Global configuration instance
 AppConfig appConfig;
 
-// Transliterate extended Latin characters to ASCII for display
-String transliterate_to_ascii(String str) {
-    // Serbian/Croatian/Bosnian characters
-    str.replace("š", "s");
-    str.replace("Š", "S");
-    str.replace("č", "c");
-    str.replace("Č", "C");
-    str.replace("ć", "c");
-    str.replace("Ć", "C");
-    str.replace("ž", "z");
-    str.replace("Ž", "Z");
-    str.replace("đ", "d");
-    str.replace("Đ", "D");
-    // German characters
-    str.replace("ü", "u");
-    str.replace("Ü", "U");
-    str.replace("ö", "o");
-    str.replace("Ö", "O");
-    str.replace("ä", "a");
-    str.replace("Ä", "A");
-    str.replace("ß", "ss");
-    // French characters
-    str.replace("é", "e");
-    str.replace("É", "E");
-    str.replace("è", "e");
-    str.replace("È", "E");
-    str.replace("ê", "e");
-    str.replace("Ê", "E");
-    str.replace("à", "a");
-    str.replace("À", "A");
-    str.replace("â", "a");
-    str.replace("Â", "A");
-    str.replace("ô", "o");
-    str.replace("Ô", "O");
-    str.replace("î", "i");
-    str.replace("Î", "I");
-    str.replace("ç", "c");
-    str.replace("Ç", "C");
-    // Spanish characters
-    str.replace("ñ", "n");
-    str.replace("Ñ", "N");
-    str.replace("á", "a");
-    str.replace("Á", "A");
-    str.replace("í", "i");
-    str.replace("Í", "I");
-    str.replace("ó", "o");
-    str.replace("Ó", "O");
-    str.replace("ú", "u");
-    str.replace("Ú", "U");
-    return str;
-}
-
 // Display and LVGL objects
 TFT_eSPI tft = TFT_eSPI();
 SPIClass touch_spi = SPIClass(HSPI);
@@ -76,54 +38,6 @@ static bool touch_ready = false;
 static lv_disp_draw_buf_t draw_buf;
 static lv_color_t buf[240 * 10];
 
-// UI elements
-lv_obj_t *temp_label;
-lv_obj_t *weather_label;
-lv_obj_t *humidity_label;
-lv_obj_t *city_label;
-lv_obj_t *update_label;
-lv_obj_t *status_label;
-lv_obj_t *weather_icon;
-lv_obj_t *forecast_container;
-lv_obj_t *time_label;
-
-struct ForecastUI {
-    lv_obj_t *day_label;
-    lv_obj_t *icon;
-    lv_obj_t *temp_label;
-};
-
-ForecastUI forecast_items[3];
-
-struct IconEntry {
-    const char *code;
-    const lv_img_dsc_t *image;
-};
-
-static const IconEntry ICON_MAP[] = {
-    {"01d", &image_weather_icon_01d},
-    {"01n", &image_weather_icon_01n},
-    {"02d", &image_weather_icon_02d},
-    {"02n", &image_weather_icon_02n},
-    {"03d", &image_weather_icon_03d},
-    {"03n", &image_weather_icon_03n},
-    {"04d", &image_weather_icon_04d},
-    {"04n", &image_weather_icon_04n},
-    {"09d", &image_weather_icon_09d},
-    {"09n", &image_weather_icon_09n},
-    {"10d", &image_weather_icon_10d},
-    {"10n", &image_weather_icon_10n},
-    {"11d", &image_weather_icon_11d},
-    {"11n", &image_weather_icon_11n},
-    {"13d", &image_weather_icon_13d},
-    {"13n", &image_weather_icon_13n},
-    {"50d", &image_weather_icon_50d},
-    {"50n", &image_weather_icon_50n},
-};
-
-static const char *DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
-static const uint16_t WEATHER_ICON_SOURCE_SIZE = 100;
-static const uint16_t FORECAST_ICON_SIZE = 44;
 static const uint16_t SCREEN_WIDTH = 240;
 static const uint16_t SCREEN_HEIGHT = 320;
 
@@ -151,28 +65,8 @@ static const bool TOUCH_SWAP_XY = true;
 static const bool TOUCH_INVERT_X = false;
 static const bool TOUCH_INVERT_Y = true;
 
-// Weather data
-struct WeatherData {
-    float temperature;
-    float feels_like;
-    int humidity;
-    String description;
-    String icon;
-    String city;
-    String last_update_time;
-};
-
 WeatherData weather;
-struct ForecastEntry {
-    String day;
-    float temp_min;
-    float temp_max;
-    String icon;
-    bool valid;
-};
-
-ForecastEntry forecast_data[3];
-unsigned long lastUpdate = 0;
+ForecastEntry forecast_data[FORECAST_DAYS];
 unsigned long lastTimeUpdate = 0;
 long global_timezone_offset = 0;
 
@@ -185,6 +79,7 @@ static size_t brightness_index = 1;
 
 // Display flushing callback
 void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color_p) {
+    ProfileScope profile(STAGE_DISP_FLUSH);
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
 
@@ -196,32 +91,6 @@ void my_disp_flush(lv_disp_drv_t *disp, const lv_area_t *area, lv_color_t *color
     lv_disp_flush_ready(disp);
 }
 
-const lv_img_dsc_t *get_icon_for_code(const String &icon_code) {
-    for (const auto &entry : ICON_MAP) {
-        if (icon_code == entry.code) {
-            return entry.image;
-        }
-    }
-    return &image_weather_icon_01d;
-}
-
-void set_icon_size(lv_obj_t *img_obj, uint16_t size_px) {
-    if (!img_obj || WEATHER_ICON_SOURCE_SIZE == 0) {
-        return;
-    }
-    uint32_t zoom = (static_cast<uint32_t>(size_px) * 256U) / WEATHER_ICON_SOURCE_SIZE;
-    lv_img_set_zoom(img_obj, zoom);
-}
-
-void set_icon_size_with_crop(lv_obj_t *img_obj, uint16_t size_px, float crop_factor) {
-    if (!img_obj || WEATHER_ICON_SOURCE_SIZE == 0) {
-        return;
-    }
-    // Apply crop_factor to zoom in and crop the transparent padding
-    uint32_t zoom = (static_cast<uint32_t>(size_px * crop_factor) * 256U) / WEATHER_ICON_SOURCE_SIZE;
-    lv_img_set_zoom(img_obj, zoom);
-}
-
 static lv_coord_t map_touch_coord(int32_t raw, int32_t raw_min, int32_t raw_max, lv_coord_t resolution, bool invert_axis) {
     raw = constrain(raw, raw_min, raw_max);
     long mapped = map(raw, raw_min, raw_max, 0, resolution - 1);
@@ -252,61 +121,6 @@ void my_touchpad_read(lv_indev_drv_t *indev_driver, lv_indev_data_t *data) {
     data->point.y = last_y;
 }
 
-void hide_status_message() {
-    if (!status_label) {
-        return;
-    }
-    lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
-}
-
-void show_status_message(const char *message, uint32_t color) {
-    if (!status_label) {
-        return;
-    }
-    lv_label_set_text(status_label, message);
-    lv_obj_set_style_text_color(status_label, lv_color_hex(color), 0);
-    lv_obj_clear_flag(status_label, LV_OBJ_FLAG_HIDDEN);
-}
-
-void update_forecast_ui() {
-    for (int i = 0; i < 3; ++i) {
-        if (!forecast_items[i].day_label) {
-            continue;
-        }
-
-        if (forecast_data[i].valid) {
-            char temp_buffer[16];
-            snprintf(temp_buffer, sizeof(temp_buffer), "%.0f°/%.0f°", forecast_data[i].temp_max, forecast_data[i].temp_min);
-            lv_label_set_text(forecast_items[i].day_label, forecast_data[i].day.c_str());
-            lv_label_set_text(forecast_items[i].temp_label, temp_buffer);
-            lv_img_set_src(forecast_items[i].icon, get_icon_for_code(forecast_data[i].icon));
-        } else {
-            lv_label_set_text(forecast_items[i].day_label, "--");
-            lv_label_set_text(forecast_items[i].temp_label, "--°/--°");
-            lv_img_set_src(forecast_items[i].icon, &image_weather_icon_01d);
-        }
-        // set_icon_size_with_crop(forecast_items[i].icon, FORECAST_ICON_SIZE, 1.8);
-
-        set_icon_size(forecast_items[i].icon, FORECAST_ICON_SIZE);
-        lv_obj_set_style_translate_y(forecast_items[i].icon, -15, 0);
-        lv_obj_set_style_translate_y(forecast_items[i].day_label, -38, 0);
-        lv_obj_set_style_translate_y(forecast_items[i].temp_label, -38, 0);
-
-        // lv_obj_set_height(forecast_items[i].icon, FORECAST_ICON_SIZE);
-        // lv_obj_set_style_transform_pivot_y(forecast_items[i].icon, 0, 0);
-    }
-}
-
-void reset_forecast_data() {
-    for (auto &entry : forecast_data) {
-        entry.valid = false;
-        entry.day = "";
-        entry.icon = "01d";
-        entry.temp_max = 0.0f;
-        entry.temp_min = 0.0f;
-    }
-}
-
 void apply_backlight_level() {
     ledcWrite(BACKLIGHT_PWM_CHANNEL, BRIGHTNESS_LEVELS[brightness_index]);
     Serial.printf("Backlight set to %u%%\n", BRIGHTNESS_PERCENT[brightness_index]);
@@ -331,72 +145,48 @@ void cycle_backlight_level() {
 }
 
 void on_screen_click(lv_event_t *event) {
-    if (lv_event_get_code(event) == LV_EVENT_CLICKED) {
+    // A long press also ends in CLICKED, so only short taps change brightness
+    if (lv_event_get_code(event) == LV_EVENT_SHORT_CLICKED) {
         cycle_backlight_level();
     }
 }
 
-String format_update_time(long epoch_seconds, long timezone_offset_seconds) {
-    if (epoch_seconds <= 0) {
-        return String();
-    }
-
-    time_t adjusted_time = static_cast<time_t>(epoch_seconds + timezone_offset_seconds);
-    struct tm timeinfo;
-    if (!gmtime_r(&adjusted_time, &timeinfo)) {
-        return String();
-    }
-
-    char buffer[16];
-    size_t written = strftime(buffer, sizeof(buffer), "%H:%M", &timeinfo);
-    if (written == 0) {
-        return String();
+void on_screen_long_press(lv_event_t *event) {
+    if (lv_event_get_code(event) == LV_EVENT_LONG_PRESSED) {
+        perf_overlay_toggle();
     }
+}
 
-    return String(buffer);
+// Transparent layer over the whole screen that receives taps and long presses
+void create_touch_layer() {
+    lv_obj_t *touch_layer = lv_obj_create(lv_scr_act());
+    lv_obj_remove_style_all(touch_layer);
+    lv_obj_set_size(touch_layer, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_pos(touch_layer, 0, 0);
+    lv_obj_set_style_bg_opa(touch_layer, LV_OPA_TRANSP, 0);
+    lv_obj_clear_flag(touch_layer, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(touch_layer, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(touch_layer, on_screen_click, LV_EVENT_SHORT_CLICKED, NULL);
+    lv_obj_add_event_cb(touch_layer, on_screen_long_press, LV_EVENT_LONG_PRESSED, NULL);
 }
 
+// Starts SNTP, which sets the clock in the background. Until it answers the
+// forecast asks for all slots and the refresh scheduler counts days from boot.
+static bool ntp_started = false;
+
 void configure_ntp_time() {
     Serial.println("Configuring NTP time...");
     configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-
-    // Wait for time to be set
-    int retry = 0;
-    const int retry_count = 10;
-    while (time(nullptr) < 100000 && retry < retry_count) {
-        Serial.print(".");
-        delay(500);
-        retry++;
-    }
-
-    if (time(nullptr) < 100000) {
-        Serial.println("\nFailed to obtain time from NTP");
-    } else {
-        Serial.println("\nTime synchronized with NTP");
-    }
+    ntp_started = true;
 }
 
-void update_time_display() {
-    if (!time_label) {
-        return;
-    }
-
-    time_t now_utc = time(nullptr);
-    if (now_utc < 100000) {
-        lv_label_set_text(time_label, "--:--");
-        return;
-    }
-
-    time_t local_time = now_utc + global_timezone_offset;
-    struct tm timeinfo;
-    if (!gmtime_r(&local_time, &timeinfo)) {
-        lv_label_set_text(time_label, "--:--");
-        return;
+// Reports when NTP first sets the clock; polled from loop(), never waits
+void check_ntp_time() {
+    static bool synchronized = false;
+    if (ntp_started && !synchronized && time(nullptr) >= 100000) {
+        synchronized = true;
+        Serial.printf("Time synchronized with NTP %lu ms after boot\n", (unsigned long)millis());
     }
-
-    char time_buffer[32];
-    strftime(time_buffer, sizeof(time_buffer), "%H:%M", &timeinfo);
-    lv_label_set_text(time_label, time_buffer);
 }
 
 // Initialize LVGL display
@@ -420,9 +210,19 @@ void lvgl_init() {
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = 240;
     disp_drv.ver_res = 320;
+#if HEADLESS_DISPLAY
+    headless_display_init(&disp_drv);
+#else
     disp_drv.flush_cb = my_disp_flush;
+#endif
     disp_drv.draw_buf = &draw_buf;
-    lv_disp_drv_register(&disp_drv);
+    disp_drv.monitor_cb = perf_overlay_monitor_cb;
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+#if HEADLESS_DISPLAY
+    headless_display_attach(disp);
+#else
+    LV_UNUSED(disp);
+#endif
 
     static lv_indev_drv_t indev_drv;
     lv_indev_drv_init(&indev_drv);
@@ -431,540 +231,771 @@ void lvgl_init() {
     lv_indev_drv_register(&indev_drv);
 }
 
-// Create UI
-void create_ui() {
-    lv_obj_t *scr = lv_scr_act();
-    lv_obj_set_style_bg_color(scr, lv_color_hex(0x1E1E1E), 0);
-    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_scrollbar_mode(scr, LV_SCROLLBAR_MODE_OFF);
-
-    status_label = lv_label_create(scr);
-    lv_label_set_text(status_label, "");
-    lv_obj_set_style_text_color(status_label, lv_color_hex(0xFF5555), 0);
-    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
-    lv_obj_align(status_label, LV_ALIGN_TOP_MID, 0, 6);
-    lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
-
-    city_label = lv_label_create(scr);
-    lv_label_set_text(city_label, "Loading...");
-    lv_obj_set_style_text_color(city_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(city_label, &lv_font_montserrat_20, 0);
-    lv_obj_align(city_label, LV_ALIGN_TOP_MID, 0, 16);
-
-    time_label = lv_label_create(scr);
-    lv_label_set_text(time_label, "--:--");
-    lv_obj_set_style_text_color(time_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(time_label, &lv_font_montserrat_28, 0);
-    lv_obj_align(time_label, LV_ALIGN_TOP_MID, 0, 42);
-
-    weather_icon = lv_img_create(scr);
-    lv_img_set_src(weather_icon, &image_weather_icon_01d);
-    lv_obj_align(weather_icon, LV_ALIGN_TOP_MID, 0, 35);
-    set_icon_size(weather_icon, 72);
-
-    temp_label = lv_label_create(scr);
-    lv_label_set_text(temp_label, "--,-°C");
-    lv_obj_set_style_text_color(temp_label, lv_color_hex(0xFFFFFF), 0);
-    lv_obj_set_style_text_font(temp_label, &lv_font_montserrat_36, 0);
-    lv_obj_align_to(temp_label, weather_icon, LV_ALIGN_TOP_MID, 0, 80);
-
-    weather_label = lv_label_create(scr);
-    lv_label_set_text(weather_label, "--------- ------");
-    lv_obj_set_style_text_color(weather_label, lv_color_hex(0xBBBBBB), 0);
-    lv_obj_set_style_text_font(weather_label, &lv_font_montserrat_18, 0);
-    lv_obj_set_style_text_align(weather_label, LV_TEXT_ALIGN_CENTER, 0);
-    lv_obj_set_width(weather_label, 240);
-    lv_obj_align(weather_label, LV_ALIGN_TOP_MID, 0, 152);
-
-    humidity_label = lv_label_create(scr);
-    lv_label_set_text(humidity_label, "Humidity: --%");
-    lv_obj_set_style_text_color(humidity_label, lv_color_hex(0xBBBBBB), 0);
-    lv_obj_set_style_text_font(humidity_label, &lv_font_montserrat_16, 0);
-    lv_obj_align_to(humidity_label, weather_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 8);
-
-    forecast_container = lv_obj_create(scr);
-    lv_obj_set_width(forecast_container, 220);
-    lv_obj_set_height(forecast_container, 90);
-    lv_obj_align(forecast_container, LV_ALIGN_BOTTOM_MID, 0, -5);
-    lv_obj_set_style_bg_color(forecast_container, lv_color_hex(0x2A2A2A), 0);
-    lv_obj_set_style_border_width(forecast_container, 0, 0);
-    lv_obj_set_style_radius(forecast_container, 12, 0);
-    lv_obj_set_style_pad_all(forecast_container, 4, 0);
-    lv_obj_set_style_pad_row(forecast_container, 0, 0);
-    lv_obj_set_style_pad_column(forecast_container, 4, 0);
-    lv_obj_set_flex_flow(forecast_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(forecast_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_clear_flag(forecast_container, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_scroll_dir(forecast_container, LV_DIR_NONE);
-    lv_obj_set_scrollbar_mode(forecast_container, LV_SCROLLBAR_MODE_OFF);
-
-    for (int i = 0; i < 3; ++i) {
-        lv_obj_t *item = lv_obj_create(forecast_container);
-        lv_obj_set_width(item, 64);
-        lv_obj_set_height(item, LV_SIZE_CONTENT); // LV_SIZE_CONTENT
-        lv_obj_set_style_bg_color(item, lv_color_hex(0x2A2A2A), 0);
-        lv_obj_set_style_border_width(item, 0, 0);
-        lv_obj_set_style_radius(item, 10, 0);
-        lv_obj_set_style_pad_all(item, 2, 0);
-        lv_obj_set_style_pad_row(item, 0, 0);
-        lv_obj_set_flex_flow(item, LV_FLEX_FLOW_COLUMN);
-        lv_obj_set_flex_align(item, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-        lv_obj_clear_flag(item, LV_OBJ_FLAG_SCROLLABLE);
-        lv_obj_set_scroll_dir(item, LV_DIR_NONE);
-        lv_obj_set_scrollbar_mode(item, LV_SCROLLBAR_MODE_OFF);
-
-        forecast_items[i].icon = lv_img_create(item);
-        lv_img_set_src(forecast_items[i].icon, &image_weather_icon_01d);
-        set_icon_size(forecast_items[i].icon, FORECAST_ICON_SIZE);
-        lv_obj_set_style_pad_all(forecast_items[i].icon, 0, 0);
-        lv_obj_add_flag(forecast_items[i].icon, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
-        lv_obj_set_style_transform_pivot_y(forecast_items[i].icon, 0, 0);
-        lv_obj_set_style_translate_y(forecast_items[i].icon, -5, 0);
-
-        forecast_items[i].day_label = lv_label_create(item);
-        lv_label_set_text(forecast_items[i].day_label, "---");
-        lv_obj_set_style_text_color(forecast_items[i].day_label, lv_color_hex(0xFFFFFF), 0);
-        lv_obj_set_style_text_font(forecast_items[i].day_label, &lv_font_montserrat_12, 0);
-        lv_obj_set_style_text_align(forecast_items[i].day_label, LV_TEXT_ALIGN_CENTER, 0);
-        lv_obj_set_style_pad_all(forecast_items[i].day_label, 0, 0);
-        lv_obj_set_style_translate_y(forecast_items[i].day_label, -10, 0);
-
-        forecast_items[i].temp_label = lv_label_create(item);
-        lv_label_set_text(forecast_items[i].temp_label, "--°/--°");
-        lv_obj_set_style_text_color(forecast_items[i].temp_label, lv_color_hex(0xBBBBBB), 0);
-        lv_obj_set_style_text_font(forecast_items[i].temp_label, &lv_font_montserrat_10, 0);
-        lv_obj_set_style_text_align(forecast_items[i].temp_label, LV_TEXT_ALIGN_CENTER, 0);
-        lv_obj_set_style_pad_all(forecast_items[i].temp_label, 0, 0);
-        lv_obj_set_style_translate_y(forecast_items[i].temp_label, -10, 0);
-    }
-
-    update_label = lv_label_create(scr);
-    lv_label_set_text(update_label, "Last update: --:--");
-    lv_obj_set_style_text_color(update_label, lv_color_hex(0x888888), 0);
-    lv_obj_set_style_text_font(update_label, &lv_font_montserrat_10, 0);
-    lv_obj_align_to(update_label, forecast_container, LV_ALIGN_OUT_TOP_MID, 0, -6);
-
-    lv_obj_t *touch_layer = lv_obj_create(scr);
-    lv_obj_remove_style_all(touch_layer);
-    lv_obj_set_size(touch_layer, LV_PCT(100), LV_PCT(100));
-    lv_obj_set_pos(touch_layer, 0, 0);
-    lv_obj_set_style_bg_opa(touch_layer, LV_OPA_TRANSP, 0);
-    lv_obj_clear_flag(touch_layer, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_add_flag(touch_layer, LV_OBJ_FLAG_CLICKABLE);
-    lv_obj_add_event_cb(touch_layer, on_screen_click, LV_EVENT_CLICKED, NULL);
+// Result of one refresh, filled on the network task and copied by value
+// through refresh_results to the loop task, which owns LVGL. The network
+// task keeps the last good data in it, so a refresh that found nothing new
+// (304 Not Modified, same observation time) still carries complete data.
+struct WeatherUpdate {
+    bool weather_ok;
+    bool forecast_ok;
+    WeatherData weather;
+    ForecastEntry forecast[FORECAST_DAYS];
+    long timezone_offset;
+    char status[24];            // shown on screen when not empty
+    uint32_t status_color;
+    RefreshOutcome outcome;
+    uint8_t api_calls;          // requests the server answered
+};
 
-    update_forecast_ui();
-}
+// Network task: blocks on refresh_requests, runs the HTTP requests and JSON
+// parsing on core 0 so loop() keeps rendering and reading touch on core 1
+// 12 KB: the mbedtls handshake (key exchange, certificate verification) runs on it
+static const uint32_t NETWORK_TASK_STACK_SIZE = 12288;
+static const UBaseType_t NETWORK_TASK_PRIORITY = 1;
+static const BaseType_t NETWORK_TASK_CORE = 0;
+
+// What a refresh request asks for; the current conditions are always fetched
+static const uint8_t REFRESH_CURRENT = 0x01;
+static const uint8_t REFRESH_FORECAST = 0x02;
+
+static QueueHandle_t refresh_requests = nullptr;
+static QueueHandle_t refresh_results = nullptr;
+static bool refresh_in_flight = false;
+// Requests answered by the server in the current refresh, for the daily
+// call budget. Only used by the network task.
+static uint8_t api_calls_made = 0;
+
+// One keep-alive connection shared by the weather and forecast requests and
+// kept open between refreshes, so a refresh usually costs no DNS lookup or
+// TCP handshake. Over HTTPS the client also keeps the TLS session, so a new
+// connection resumes it instead of doing a full handshake. Only used by the
+// network task.
+static TlsClient api_client;
+static ApiHttpClient api_http;
+// weather_api_host split into name and port, for connecting by address
+static char api_host_name[64];
+static uint16_t api_host_port = 80;
+
+// Validators of the last response that was parsed successfully, sent back
+// as If-None-Match/If-Modified-Since so an unchanged resource costs a 304
+// without a body
+struct ResponseValidators {
+    char etag[64];
+    char last_modified[32];
+};
 
-// Update weather icon based on OpenWeatherMap icon code
-void update_weather_icon(const String &icon_code) {
-    lv_img_set_src(weather_icon, get_icon_for_code(icon_code));
+static ResponseValidators weather_validators;
+static ResponseValidators forecast_validators;
+static ResponseValidators onecall_validators;
+static ResponseValidators onecall_current_validators;
+
+// Local day of year the displayed forecast was built for. The days shown
+// depend on the date, so the first refresh of a new day always includes the
+// forecast and sends no validators for it.
+static int forecast_yday = -1;
+
+static void api_begin(const char *url, const ResponseValidators *validators) {
+    api_http.begin(api_client, url);
+    if (validators && validators->etag[0] != '\0') {
+        api_http.addHeader("If-None-Match", validators->etag);
+    }
+    if (validators && validators->last_modified[0] != '\0') {
+        api_http.addHeader("If-Modified-Since", validators->last_modified);
+    }
 }
 
-// Update UI with weather data
-void update_ui() {
-    char temp_str[32];
-    char humidity_str[32];
-    char update_str[64];
+// Remembers the validators of the current response; ones that do not fit are
+// dropped, since a truncated ETag would never match
+static void api_save_validators(ResponseValidators &validators) {
+    String etag = api_http.header("ETag");
+    String last_modified = api_http.header("Last-Modified");
+    copy_text(validators.etag, sizeof(validators.etag),
+              etag.length() < sizeof(validators.etag) ? etag.c_str() : "");
+    copy_text(validators.last_modified, sizeof(validators.last_modified),
+              last_modified.length() < sizeof(validators.last_modified) ? last_modified.c_str() : "");
+}
 
-    sprintf(temp_str, "%.1f°C", weather.temperature);
-    lv_label_set_text(temp_label, temp_str);
+// CA certificate for the API host, read from the SD card at startup; the
+// built-in roots (API_CA_PEM) are used when there is none
+static String api_ca_pem;
 
-    // Transliterate city name to ASCII for proper display
-    String displayCity = transliterate_to_ascii(weather.city);
-    lv_label_set_text(city_label, displayCity.c_str());
+static const char *api_scheme() {
+    return appConfig.weather_api_https ? "https://" : "http://";
+}
 
-    // Transliterate weather description to ASCII
-    String desc = transliterate_to_ascii(weather.description);
-    if (desc.length() > 0) {
-        desc[0] = toupper(desc[0]);
+static void api_parse_host() {
+    copy_text(api_host_name, sizeof(api_host_name), appConfig.weather_api_host);
+    char *colon = strchr(api_host_name, ':');
+    api_host_port = appConfig.weather_api_https ? 443 : 80;
+    if (colon) {
+        *colon = '\0';
+        api_host_port = static_cast<uint16_t>(atoi(colon + 1));
     }
-    lv_label_set_text(weather_label, desc.c_str());
+}
 
-    // Update weather icon
-    update_weather_icon(weather.icon);
+// Request URLs, formatted once from the configuration by api_build_urls() so
+// a refresh builds no Strings. The masked twin, with the API key replaced, is
+// what gets logged. What changes per request (forecast slot count, One Call
+// coordinates) is written after the fixed part by api_url_set_tail().
+#define API_URL_SIZE 320
+
+struct ApiUrl {
+    char full[API_URL_SIZE];
+    char masked[API_URL_SIZE];
+    size_t full_fixed;   // length of the fixed part
+    size_t masked_fixed;
+};
 
-    sprintf(humidity_str, "Humidity: %d%%", weather.humidity);
-    lv_label_set_text(humidity_label, humidity_str);
+static ApiUrl weather_url;
+static ApiUrl forecast_url;
+static ApiUrl onecall_url;
 
-    if (weather.last_update_time.length() > 0) {
-        snprintf(update_str, sizeof(update_str), "Last update: %s", weather.last_update_time.c_str());
-    } else {
-        snprintf(update_str, sizeof(update_str), "Last update: --:--");
+static void api_url_init(ApiUrl &url, const char *path) {
+    const int length = snprintf(url.full, sizeof(url.full), "%s%s%s&appid=%s", api_scheme(),
+                                appConfig.weather_api_host, path, appConfig.weather_api_key);
+    snprintf(url.masked, sizeof(url.masked), "%s%s%s&appid=********", api_scheme(), appConfig.weather_api_host, path);
+    if (length < 0 || static_cast<size_t>(length) >= sizeof(url.full)) {
+        Serial.printf("API URL for %s too long, truncated\n", path);
     }
-    lv_label_set_text(update_label, update_str);
+    url.full_fixed = strlen(url.full);
+    url.masked_fixed = strlen(url.masked);
+}
 
-    hide_status_message();
+static void api_url_set_tail(ApiUrl &url, const char *tail) {
+    copy_text(url.full + url.full_fixed, sizeof(url.full) - url.full_fixed, tail);
+    copy_text(url.masked + url.masked_fixed, sizeof(url.masked) - url.masked_fixed, tail);
 }
 
-// WiFi status code to string
-const char* wifi_status_to_string(int status) {
-    switch(status) {
-        case WL_IDLE_STATUS: return "IDLE";
-        case WL_NO_SSID_AVAIL: return "NO_SSID_AVAILABLE";
-        case WL_SCAN_COMPLETED: return "SCAN_COMPLETED";
-        case WL_CONNECTED: return "CONNECTED";
-        case WL_CONNECT_FAILED: return "CONNECT_FAILED";
-        case WL_CONNECTION_LOST: return "CONNECTION_LOST";
-        case WL_DISCONNECTED: return "DISCONNECTED";
-        default: return "UNKNOWN";
+void api_build_urls() {
+    char path[128];
+    snprintf(path, sizeof(path), "/data/2.5/weather?q=%s,%s&units=%s", appConfig.weather_city,
+             appConfig.weather_country_code, appConfig.weather_units);
+    api_url_init(weather_url, path);
+    snprintf(path, sizeof(path), "/data/2.5/forecast?q=%s,%s&units=%s", appConfig.weather_city,
+             appConfig.weather_country_code, appConfig.weather_units);
+    api_url_init(forecast_url, path);
+    snprintf(path, sizeof(path), "/data/3.0/onecall?units=%s", appConfig.weather_units);
+    api_url_init(onecall_url, path);
+}
+
+// Opens the shared connection to the cached address of the API host.
+// HTTPClient then reuses it instead of resolving the name itself, and still
+// sends the name in the Host header. An address that refuses the connection
+// is resolved again, since the host may have moved.
+static void api_connect() {
+    IPAddress address;
+    if (!dns_cache_resolve(api_host_name, address)) {
+        return;
+    }
+    bool connected = api_client.connect(address, api_host_port);
+    if (!connected) {
+        dns_cache_invalidate();
+        if (dns_cache_resolve(api_host_name, address)) {
+            connected = api_client.connect(address, api_host_port);
+        }
+    }
+    if (connected && api_client.secure()) {
+        Serial.printf("TLS handshake: %lu ms (%s)\n", (unsigned long)api_client.lastHandshakeMs(),
+                      api_client.lastHandshakeResumed() ? "resumed" : "full");
     }
 }
 
-// Connect to WiFi
-bool connect_wifi() {
-    Serial.println("\n=========================================");
-    Serial.println("Starting WiFi connection...");
-    Serial.println("=========================================");
-    Serial.printf("SSID: '%s'\n", appConfig.wifi_ssid);
-    Serial.printf("SSID Length: %d characters\n", strlen(appConfig.wifi_ssid));
-    Serial.printf("Password Length: %d characters\n", strlen(appConfig.wifi_password));
-    Serial.println("-----------------------------------------");
+// Starts a GET on the shared connection. The server drops idle keep-alive
+// connections, which may only show up once the request is written, so a
+// request that fails on a reused connection is retried once on a new one.
+static int api_get(const char *url, const ResponseValidators *validators) {
+    api_http.setReuse(true);
+    const bool reused = api_client.connected();
+    if (!reused) {
+        api_connect();
+    }
+    api_begin(url, validators);
+    int httpCode = api_http.GET();
+    if (httpCode < 0 && reused) {
+        Serial.printf("Reused connection failed (%s), reconnecting\n", HTTPClient::errorToString(httpCode).c_str());
+        api_http.end();
+        api_client.stop();
+        api_connect();
+        api_begin(url, validators);
+        httpCode = api_http.GET();
+    } else if (reused) {
+        Serial.println("Reused API connection");
+    }
+    if (httpCode > 0) {
+        api_calls_made++;
+    }
+    return httpCode;
+}
 
-    // Disconnect any previous connection
-    WiFi.disconnect(true);
-    delay(100);
+// Deserializes the body of the current response straight from the socket,
+// so the payload is never held in memory as a whole. A gzip body is inflated
+// on the way; only the deflate window is buffered. Only the fields in filter
+// are stored in doc.
+static DeserializationError api_read_json(JsonDocument &doc, const JsonDocument &filter) {
+    const bool chunked = api_http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+    const bool gzip = api_http.header("Content-Encoding").equalsIgnoreCase("gzip");
+    HttpBodyStream body(api_http.getStream(), chunked, api_http.getSize());
+    GzipStream inflated(body);
+    DeserializationError error;
+    {
+        ProfileScope parse_profile(STAGE_DESERIALIZE);
+        if (gzip) {
+            error = deserializeJson(doc, inflated, DeserializationOption::Filter(filter));
+        } else {
+            error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+        }
+    }
+    if (gzip) {
+        if (!inflated.finish()) {
+            Serial.printf("gzip body corrupt: %s\n", inflated.error() ? inflated.error() : "incomplete");
+            if (!error) {
+                error = DeserializationError::InvalidInput;
+            }
+        }
+        Serial.printf("Inflated %u -> %u bytes\n", (unsigned)body.bytes_read(), (unsigned)inflated.bytes_out());
+    }
+    // Whatever follows the document (a newline, the last chunk) is consumed
+    // so the next request on this connection starts at its response
+    if (!body.finish()) {
+        Serial.println("Response body cut short, closing connection");
+        api_client.stop();
+    }
+    return error;
+}
 
-    // Set WiFi mode to station
-    WiFi.mode(WIFI_STA);
-    delay(100);
+// Marks the refresh as failed; the outcome decides how soon it is retried
+static void set_update_error(WeatherUpdate &update, const char *text, RefreshOutcome outcome) {
+    copy_text(update.status, sizeof(update.status), text);
+    update.status_color = 0xFF0000;
+    update.outcome = outcome;
+}
 
-    // Scan for networks to verify SSID exists
-    Serial.println("Scanning for WiFi networks...");
-    int networksFound = WiFi.scanNetworks();
-    Serial.printf("Found %d networks:\n", networksFound);
+static RefreshOutcome http_error_outcome(int httpCode) {
+    return httpCode < 0 ? REFRESH_NETWORK_ERROR : REFRESH_API_ERROR;
+}
 
-    bool ssidFound = false;
-    for (int i = 0; i < networksFound; i++) {
-        String ssid = WiFi.SSID(i);
-        int rssi = WiFi.RSSI(i);
-        String encryption = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN) ? "Open" : "Encrypted";
+// Fetch weather data (runs on the network task, must not touch LVGL)
+bool fetch_weather(WeatherUpdate &update) {
+    ProfileScope profile(STAGE_FETCH_WEATHER);
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_FETCH_WEATHER);
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("WiFi not connected");
+        set_update_error(update, "No WiFi", REFRESH_NETWORK_ERROR);
+        return false;
+    }
 
-        Serial.printf("  %d: %s (%d dBm) %s", i + 1, ssid.c_str(), rssi, encryption.c_str());
+    Serial.println("Fetching weather data...");
+    Serial.print("API URL: ");
+    Serial.println(weather_url.masked);
 
-        if (ssid == String(appConfig.wifi_ssid)) {
-            Serial.print(" <- TARGET NETWORK FOUND!");
-            ssidFound = true;
-        }
-        Serial.println();
-    }
+    int httpCode = api_get(weather_url.full, &weather_validators);
 
-    if (!ssidFound) {
-        Serial.println("\n⚠️  WARNING: Target SSID not found in scan!");
-        Serial.println("    - Check SSID spelling in conf.txt");
-        Serial.println("    - Ensure network is 2.4GHz (ESP32 doesn't support 5GHz)");
-        Serial.println("    - Move closer to the router");
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        Serial.println("Weather not modified");
+        update.weather_ok = true;
+        api_http.end();
+        return true;
     }
 
-    Serial.println("-----------------------------------------");
+    if (httpCode == 200) {
+        mem_diag_mark(MEM_PHASE_WEATHER_RESPONSE);
 
-    // Begin WiFi connection
-    WiFi.begin(appConfig.wifi_ssid, appConfig.wifi_password);
-    Serial.print("Connecting to WiFi");
+        DynamicJsonDocument doc(WEATHER_JSON_CAPACITY);
+        DeserializationError error = api_read_json(doc, current_weather_filter());
+        mem_diag_mark(MEM_PHASE_WEATHER_PARSED);
 
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 40) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
+        if (!error) {
+            // Current conditions are only updated every ~10 minutes
+            const long observed_at = doc["dt"] | 0L;
+            if (observed_at != 0 && observed_at == update.weather.observed_at) {
+                Serial.println("Weather observation unchanged");
+            } else {
+                update.timezone_offset = parse_current_weather(doc, update.weather);
+
+                Serial.println("Weather data updated successfully");
+                Serial.printf("Temperature: %.1f°C\n", update.weather.temperature);
+                Serial.printf("Humidity: %d%%\n", update.weather.humidity);
+                Serial.printf("Description: %s\n", update.weather.description);
+            }
+            api_save_validators(weather_validators);
+            update.weather_ok = true;
 
-        // Print status every 10 attempts
-        if (attempts % 10 == 0) {
-            Serial.printf("\n  Status after %d attempts: %s", attempts, wifi_status_to_string(WiFi.status()));
+            api_http.end();
+            return true;
+        } else {
+            Serial.println("JSON parsing failed");
+            set_update_error(update, "Parse Error", REFRESH_API_ERROR);
         }
-
-        lv_timer_handler();
+    } else {
+        Serial.printf("HTTP error: %d\n", httpCode);
+        // The error body is not read, so the connection cannot be reused
+        api_client.stop();
+        set_update_error(update, "API Error", http_error_outcome(httpCode));
     }
 
-    Serial.println(); // New line after dots
-
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println("=========================================");
-        Serial.println("✓ WiFi connected successfully!");
-        Serial.println("=========================================");
-        Serial.printf("IP address: %s\n", WiFi.localIP().toString().c_str());
-        Serial.printf("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
-        Serial.printf("Subnet: %s\n", WiFi.subnetMask().toString().c_str());
-        Serial.printf("DNS: %s\n", WiFi.dnsIP().toString().c_str());
-        Serial.printf("Signal strength (RSSI): %d dBm\n", WiFi.RSSI());
-        Serial.printf("Channel: %d\n", WiFi.channel());
-        Serial.println("=========================================\n");
-        hide_status_message();
-        return true;
-    } else {
-        Serial.println("=========================================");
-        Serial.println("✗ WiFi connection FAILED!");
-        Serial.println("=========================================");
-        Serial.printf("Final status: %s\n", wifi_status_to_string(WiFi.status()));
-        Serial.printf("Attempts made: %d\n", attempts);
-        Serial.println("\nPossible issues:");
-        Serial.println("  1. Wrong password in conf.txt");
-        Serial.println("  2. SSID not found (check spelling)");
-        Serial.println("  3. Network is 5GHz (ESP32 only supports 2.4GHz)");
-        Serial.println("  4. Router security settings incompatible");
-        Serial.println("  5. Too far from router (weak signal)");
-        Serial.println("=========================================\n");
-        show_status_message("WiFi Failed!", 0xFF0000);
-        return false;
+    api_http.end();
+    return false;
+}
+
+// Day of the year in the city, -1 while NTP has not set the clock (so the
+// first refresh after it does fetches the forecast again)
+static int local_yday(time_t now_utc, long timezone_offset) {
+    if (now_utc < CLOCK_VALID_AFTER) {
+        return -1;
     }
+    time_t local_now = now_utc + timezone_offset;
+    struct tm now_info;
+    return gmtime_r(&local_now, &now_info) ? now_info.tm_yday : -1;
 }
 
-// Fetch weather data
-bool fetch_weather() {
+// Fetch the 5 day forecast (runs on the network task, must not touch LVGL)
+bool fetch_forecast(WeatherUpdate &update) {
+    ProfileScope profile(STAGE_FETCH_FORECAST);
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_FETCH_FORECAST);
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println("WiFi not connected");
-        show_status_message("No WiFi", 0xFF0000);
+        set_update_error(update, "No WiFi", REFRESH_NETWORK_ERROR);
         return false;
     }
 
-    HTTPClient http;
-    String url = "http://api.openweathermap.org/data/2.5/weather?q=";
-    url += appConfig.weather_city;
-    url += ",";
-    url += appConfig.weather_country_code;
-    url += "&units=";
-    url += appConfig.weather_units;
-    url += "&appid=";
-    url += appConfig.weather_api_key;
+    // Only the slots up to the end of the last displayed day
+    const int slots = forecast_slot_count(time(nullptr), update.timezone_offset, FORECAST_DAYS);
+    char tail[16];
+    snprintf(tail, sizeof(tail), "&cnt=%d", slots);
+    api_url_set_tail(forecast_url, tail);
 
-    Serial.println("Fetching weather data...");
-    Serial.print("API URL: http://api.openweathermap.org/data/2.5/weather?q=");
-    Serial.print(appConfig.weather_city);
-    Serial.print(",");
-    Serial.print(appConfig.weather_country_code);
-    Serial.print("&units=");
-    Serial.print(appConfig.weather_units);
-    Serial.println("&appid=********");
-    lv_timer_handler();
+    Serial.printf("Fetching forecast data (%d slots)...\n", slots);
+    Serial.print("API URL: ");
+    Serial.println(forecast_url.masked);
 
-    http.begin(url);
-    int httpCode = http.GET();
+    const int today = local_yday(time(nullptr), update.timezone_offset);
+    int httpCode = api_get(forecast_url.full, today == forecast_yday ? &forecast_validators : nullptr);
+
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        Serial.println("Forecast not modified");
+        update.forecast_ok = true;
+        api_http.end();
+        return true;
+    }
 
     if (httpCode == 200) {
-        String payload = http.getString();
+        mem_diag_mark(MEM_PHASE_FORECAST_RESPONSE);
 
-        DynamicJsonDocument doc(2048);
-        DeserializationError error = deserializeJson(doc, payload);
+        DynamicJsonDocument doc(forecast_json_capacity(slots));
+        DeserializationError error = api_read_json(doc, forecast_filter());
+        mem_diag_mark(MEM_PHASE_FORECAST_PARSED);
 
         if (!error) {
-            weather.temperature = doc["main"]["temp"];
-            weather.feels_like = doc["main"]["feels_like"];
-            weather.humidity = doc["main"]["humidity"];
-            weather.description = doc["weather"][0]["description"].as<String>();
-            weather.icon = doc["weather"][0]["icon"].as<String>();
-            weather.city = doc["name"].as<String>();
-            long update_epoch = doc["dt"] | 0L;
-            long timezone_offset = doc["timezone"] | 0L;
-            global_timezone_offset = timezone_offset;
-            weather.last_update_time = format_update_time(update_epoch, timezone_offset);
-
-            Serial.println("Weather data updated successfully");
-            Serial.printf("Temperature: %.1f°C\n", weather.temperature);
-            Serial.printf("Humidity: %d%%\n", weather.humidity);
-            Serial.printf("Description: %s\n", weather.description.c_str());
-
-            update_ui();
-            http.end();
+            aggregate_forecast(doc, time(nullptr), update.forecast, FORECAST_DAYS);
+            api_save_validators(forecast_validators);
+            forecast_yday = today;
+            update.forecast_ok = true;
+            api_http.end();
             return true;
         } else {
-            Serial.println("JSON parsing failed");
-            show_status_message("Parse Error", 0xFF0000);
+            Serial.println("Forecast JSON parsing failed");
+            set_update_error(update, "Forecast Parse Error", REFRESH_API_ERROR);
         }
     } else {
-        Serial.printf("HTTP error: %d\n", httpCode);
-        show_status_message("API Error", 0xFF0000);
+        Serial.printf("Forecast HTTP error: %d\n", httpCode);
+        // The error body is not read, so the connection cannot be reused
+        api_client.stop();
+        set_update_error(update, "Forecast API Error", http_error_outcome(httpCode));
     }
 
-    http.end();
+    api_http.end();
     return false;
 }
 
-bool fetch_forecast() {
+// Set once One Call answered 401/404: the key has no access, so the rest of
+// the session uses the two 2.5 requests
+static bool onecall_unavailable = false;
+
+static bool onecall_coordinates(const WeatherUpdate &update, float &lat, float &lon) {
+    if (appConfig.weather_lat != 0.0f || appConfig.weather_lon != 0.0f) {
+        lat = appConfig.weather_lat;
+        lon = appConfig.weather_lon;
+        return true;
+    }
+    lat = update.weather.latitude;
+    lon = update.weather.longitude;
+    return lat != 0.0f || lon != 0.0f;
+}
+
+// Current conditions and, when include_daily is set, the daily forecast in one
+// request. Sets unavailable when the endpoint is not usable with this key, so
+// the caller can fall back.
+bool fetch_onecall(WeatherUpdate &update, float lat, float lon, bool include_daily, bool &unavailable) {
+    ProfileScope profile(STAGE_FETCH_WEATHER);
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_FETCH_WEATHER);
+    unavailable = false;
     if (WiFi.status() != WL_CONNECTED) {
         Serial.println("WiFi not connected");
-        show_status_message("No WiFi", 0xFF0000);
+        set_update_error(update, "No WiFi", REFRESH_NETWORK_ERROR);
         return false;
     }
 
-    HTTPClient http;
-    String url = "http://api.openweathermap.org/data/2.5/forecast?q=";
-    url += appConfig.weather_city;
-    url += ",";
-    url += appConfig.weather_country_code;
-    url += "&units=";
-    url += appConfig.weather_units;
-    url += "&appid=";
-    url += appConfig.weather_api_key;
+    char tail[96];
+    snprintf(tail, sizeof(tail), "&lat=%.4f&lon=%.4f&exclude=%s", lat, lon,
+             include_daily ? "minutely,hourly,alerts" : "minutely,hourly,daily,alerts");
+    api_url_set_tail(onecall_url, tail);
 
-    Serial.println("Fetching forecast data...");
-    lv_timer_handler();
+    Serial.printf("Fetching One Call data (%.4f, %.4f%s)...\n", lat, lon, include_daily ? ", daily" : "");
+    Serial.print("API URL: ");
+    Serial.println(onecall_url.masked);
 
-    http.begin(url);
-    int httpCode = http.GET();
+    // The two variants are different resources with their own validators
+    ResponseValidators &validators = include_daily ? onecall_validators : onecall_current_validators;
+    const int today = local_yday(time(nullptr), update.timezone_offset);
+    const bool send_validators = !include_daily || today == forecast_yday;
+    int httpCode = api_get(onecall_url.full, send_validators ? &validators : nullptr);
+
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        Serial.println("One Call not modified");
+        update.weather_ok = true;
+        update.forecast_ok = include_daily;
+        api_http.end();
+        return true;
+    }
 
     if (httpCode == 200) {
-        String payload = http.getString();
-        DynamicJsonDocument doc(32768);
-        DeserializationError error = deserializeJson(doc, payload);
+        mem_diag_mark(MEM_PHASE_WEATHER_RESPONSE);
 
-        if (!error) {
-            reset_forecast_data();
-            JsonArray list = doc["list"].as<JsonArray>();
-            long timezone_offset = doc["city"]["timezone"] | 0L;
-            int current_yday = -1;
-            time_t now_utc = time(nullptr);
-            if (now_utc > 0) {
-                time_t local_now = now_utc + timezone_offset;
-                struct tm now_info;
-                if (gmtime_r(&local_now, &now_info)) {
-                    current_yday = now_info.tm_yday;
-                }
-            }
+        DynamicJsonDocument doc(include_daily ? ONECALL_JSON_CAPACITY : ONECALL_CURRENT_JSON_CAPACITY);
+        DeserializationError error = api_read_json(doc, onecall_filter());
+        mem_diag_mark(MEM_PHASE_WEATHER_PARSED);
 
-            struct DailyAccumulator {
-                int yday;
-                int weekday;
-                float min_temp;
-                float max_temp;
-                bool has_values;
-                String icon;
-                int icon_score;
-            };
-
-            DailyAccumulator day_data[3];
-            int day_count = 0;
-
-            if (!list.isNull()) {
-                for (JsonVariant value : list) {
-                    long raw_timestamp = value["dt"] | 0L;
-                    time_t timestamp = static_cast<time_t>(raw_timestamp + timezone_offset);
-                    struct tm timeinfo;
-                    if (!gmtime_r(&timestamp, &timeinfo)) {
-                        continue;
-                    }
-
-                    if (current_yday != -1 && timeinfo.tm_yday == current_yday) {
-                        continue;
-                    }
-
-                    int idx = -1;
-                    for (int i = 0; i < day_count; ++i) {
-                        if (day_data[i].yday == timeinfo.tm_yday) {
-                            idx = i;
-                            break;
-                        }
-                    }
-
-                    if (idx == -1) {
-                        if (day_count >= 3) {
-                            continue;
-                        }
-                        idx = day_count;
-                        day_data[idx].yday = timeinfo.tm_yday;
-                        day_data[idx].weekday = timeinfo.tm_wday;
-                        day_data[idx].min_temp = FLT_MAX;
-                        day_data[idx].max_temp = -FLT_MAX;
-                        day_data[idx].has_values = false;
-                        day_data[idx].icon = "";
-                        day_data[idx].icon_score = INT_MAX;
-                        day_count++;
-                    }
-
-                    float temp_min = value["main"]["temp_min"] | 0.0f;
-                    float temp_max = value["main"]["temp_max"] | temp_min;
-                    if (!day_data[idx].has_values) {
-                        day_data[idx].min_temp = temp_min;
-                        day_data[idx].max_temp = temp_max;
-                        day_data[idx].has_values = true;
-                    } else {
-                        day_data[idx].min_temp = min(day_data[idx].min_temp, temp_min);
-                        day_data[idx].max_temp = max(day_data[idx].max_temp, temp_max);
-                    }
-
-                    String icon = value["weather"][0]["icon"].as<String>();
-                    if (icon.length() == 0) {
-                        icon = "01d";
-                    }
-                    int hour = timeinfo.tm_hour;
-                    int score = abs(hour - 12);
-                    if (day_data[idx].icon.length() == 0 || score < day_data[idx].icon_score) {
-                        day_data[idx].icon = icon;
-                        day_data[idx].icon_score = score;
-                    }
-
-                    if (day_count >= 3 && day_data[day_count - 1].has_values && timeinfo.tm_yday > day_data[day_count - 1].yday) {
-                        bool all_collected = true;
-                        for (int i = 0; i < day_count; ++i) {
-                            if (!day_data[i].has_values) {
-                                all_collected = false;
-                                break;
-                            }
-                        }
-                        if (all_collected) {
-                            break;
-                        }
-                    }
+        if (!error) {
+            const long observed_at = doc["current"]["dt"] | 0L;
+            if (observed_at != 0 && observed_at == update.weather.observed_at) {
+                Serial.println("Weather observation unchanged");
+            } else {
+                update.timezone_offset = parse_onecall_current(doc, update.weather);
+                if (update.weather.city[0] == '\0') {
+                    copy_text(update.weather.city, sizeof(update.weather.city), appConfig.weather_city);
                 }
+                Serial.println("Weather data updated successfully");
+                Serial.printf("Temperature: %.1f°C\n", update.weather.temperature);
+                Serial.printf("Humidity: %d%%\n", update.weather.humidity);
+                Serial.printf("Description: %s\n", update.weather.description);
             }
-
-            for (int i = 0; i < day_count && i < 3; ++i) {
-                ForecastEntry &entry = forecast_data[i];
-                entry.day = DAY_NAMES[day_data[i].weekday];
-                entry.temp_min = day_data[i].has_values ? day_data[i].min_temp : 0.0f;
-                entry.temp_max = day_data[i].has_values ? day_data[i].max_temp : 0.0f;
-                entry.icon = day_data[i].icon.length() > 0 ? day_data[i].icon : "01d";
-                entry.valid = day_data[i].has_values;
+            if (include_daily) {
+                parse_onecall_daily(doc, time(nullptr), update.forecast, FORECAST_DAYS);
+                forecast_yday = today;
             }
+            api_save_validators(validators);
+            update.weather_ok = true;
+            update.forecast_ok = include_daily;
 
-            update_forecast_ui();
-            http.end();
+            api_http.end();
             return true;
         } else {
-            Serial.println("Forecast JSON parsing failed");
-            show_status_message("Forecast Parse Error", 0xFF0000);
+            Serial.println("One Call JSON parsing failed");
+            set_update_error(update, "Parse Error", REFRESH_API_ERROR);
         }
     } else {
-        Serial.printf("Forecast HTTP error: %d\n", httpCode);
-        show_status_message("Forecast API Error", 0xFF0000);
+        Serial.printf("One Call HTTP error: %d\n", httpCode);
+        // The error body is not read, so the connection cannot be reused
+        api_client.stop();
+        if (httpCode == HTTP_CODE_UNAUTHORIZED || httpCode == HTTP_CODE_NOT_FOUND) {
+            unavailable = true;
+        } else {
+            set_update_error(update, "API Error", http_error_outcome(httpCode));
+        }
     }
 
-    http.end();
+    api_http.end();
     return false;
 }
 
+// One refresh: a single One Call request when possible, otherwise (or when
+// One Call turns out to be unavailable) current weather and, when asked for
+// or on a new day, the forecast. In "onecall" mode there is no fallback: a
+// missing One Call subscription or missing coordinates is reported as an error.
+static void fetch_all(WeatherUpdate &update, bool include_forecast) {
+    if (forecast_yday != local_yday(time(nullptr), update.timezone_offset)) {
+        include_forecast = true;
+    }
+    const bool onecall_only = strcmp(appConfig.weather_api_mode, "onecall") == 0;
+    float lat = 0.0f;
+    float lon = 0.0f;
+    if (onecall_only && !onecall_coordinates(update, lat, lon)) {
+        Serial.println("weather_api_mode=onecall needs weather_lat and weather_lon in conf.txt");
+        set_update_error(update, "No Coordinates", REFRESH_API_ERROR);
+        return;
+    }
+    if (onecall_only || (strcmp(appConfig.weather_api_mode, "split") != 0 && !onecall_unavailable &&
+                         onecall_coordinates(update, lat, lon))) {
+        bool unavailable = false;
+        fetch_onecall(update, lat, lon, include_forecast, unavailable);
+        if (!unavailable) {
+            return;
+        }
+        if (onecall_only) {
+            Serial.println("One Call not available with this API key (weather_api_mode=onecall, no fallback)");
+            set_update_error(update, "No One Call Access", REFRESH_API_ERROR);
+            return;
+        }
+        Serial.println("One Call not available with this API key, using the 2.5 endpoints");
+        onecall_unavailable = true;
+    }
+    if (fetch_weather(update) && include_forecast) {
+        fetch_forecast(update);
+    }
+}
+
+void network_task(void *param) {
+    (void)param;
+    // Static so the ~300 byte snapshot does not count against the task stack,
+    // and so it keeps the last good data between refreshes
+    static WeatherUpdate update;
+    static const char *RESPONSE_HEADERS[] = {"Transfer-Encoding", "Content-Encoding", "ETag", "Last-Modified"};
+    api_http.collectHeaders(RESPONSE_HEADERS, sizeof(RESPONSE_HEADERS) / sizeof(RESPONSE_HEADERS[0]));
+    api_parse_host();
+    api_client.setSecure(appConfig.weather_api_https);
+    api_client.setServerName(api_host_name);
+    if (appConfig.weather_api_insecure) {
+        api_client.setInsecure();
+    } else {
+        api_client.setCACert(api_ca_pem.length() > 0 ? api_ca_pem.c_str() : API_CA_PEM);
+    }
+    for (;;) {
+        uint8_t request;
+        if (xQueueReceive(refresh_requests, &request, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        update.weather_ok = false;
+        update.forecast_ok = false;
+        update.status[0] = '\0';
+        update.outcome = REFRESH_OK;
+        api_calls_made = 0;
+        fetch_all(update, (request & REFRESH_FORECAST) != 0);
+        update.api_calls = api_calls_made;
+        // Depth 1: a result the loop has not picked up yet is replaced
+        xQueueOverwrite(refresh_results, &update);
+        // Renewing an expired address now keeps the lookup out of the next refresh
+        dns_cache_refresh();
+    }
+}
+
+// Reads the CA certificate named in conf.txt; without it the server is
+// verified with the built-in roots
+void load_api_ca_cert() {
+    if (!appConfig.weather_api_https) {
+        return;
+    }
+    if (appConfig.weather_api_insecure) {
+        Serial.printf("weather_api_insecure=1: %s is NOT verified, the API key is exposed to anyone on the path\n",
+                      appConfig.weather_api_host);
+        return;
+    }
+    if (SD.exists(appConfig.weather_api_ca_file)) {
+        File file = SD.open(appConfig.weather_api_ca_file);
+        if (file) {
+            api_ca_pem = file.readString();
+            file.close();
+        }
+    }
+    if (api_ca_pem.length() > 0) {
+        Serial.printf("Verifying %s with %s\n", appConfig.weather_api_host, appConfig.weather_api_ca_file);
+    } else {
+        Serial.printf("Verifying %s with the built-in root certificates\n", appConfig.weather_api_host);
+    }
+}
+
+bool start_network_task() {
+    refresh_requests = xQueueCreate(1, sizeof(uint8_t));
+    refresh_results = xQueueCreate(1, sizeof(WeatherUpdate));
+    if (!refresh_requests || !refresh_results) {
+        Serial.println("Failed to create refresh queues");
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(network_task, "network", NETWORK_TASK_STACK_SIZE, nullptr, NETWORK_TASK_PRIORITY,
+                                nullptr, NETWORK_TASK_CORE) != pdPASS) {
+        Serial.println("Failed to start network task");
+        return false;
+    }
+    return true;
+}
+
+// Asks the network task for a refresh; ignored while one is still running
+void request_refresh(bool include_forecast) {
+    if (!refresh_requests || refresh_in_flight) {
+        return;
+    }
+    mem_diag_begin_refresh();
+    uint8_t request = include_forecast ? REFRESH_CURRENT | REFRESH_FORECAST : REFRESH_CURRENT;
+    if (xQueueSend(refresh_requests, &request, 0) == pdTRUE) {
+        refresh_in_flight = true;
+    }
+}
+
+// For the boot-to-first-data time in the log
+static bool first_data_shown = false;
+
+// Shows a finished refresh and schedules the next one; runs on the loop task
+void apply_weather_update(const WeatherUpdate &update) {
+    bool changing_fast = false;
+    // Only redraw what changed, so an unchanged refresh invalidates nothing
+    if (update.weather_ok) {
+        if (update.weather.observed_at == 0 || update.weather.observed_at != weather.observed_at) {
+            changing_fast = weather.observed_at != 0 && weather_changed_fast(weather, update.weather);
+            weather = update.weather;
+            global_timezone_offset = update.timezone_offset;
+            update_ui(weather);
+            update_time_display(global_timezone_offset);
+        } else {
+            hide_status_message();
+        }
+    }
+    if (update.forecast_ok && !forecast_entries_equal(update.forecast, forecast_data, FORECAST_DAYS)) {
+        memcpy(forecast_data, update.forecast, sizeof(forecast_data));
+        update_forecast_ui(forecast_data);
+    }
+    if (update.status[0] != '\0') {
+        show_status_message(update.status, update.status_color);
+    }
+    lv_timer_handler();
+    mem_diag_mark(MEM_PHASE_RENDERED);
+    mem_diag_end_refresh(Serial);
+    if (!first_data_shown && update.weather_ok) {
+        first_data_shown = true;
+        Serial.printf("First weather data shown %lu ms after boot\n", (unsigned long)millis());
+    }
+
+    refresh_scheduler_finished(millis(), time(nullptr), update.outcome, update.api_calls, update.forecast_ok,
+                               changing_fast);
+    Serial.printf("Next refresh in %lu s (%s)\n", (unsigned long)(refresh_scheduler_next_delay_ms() / 1000),
+                  refresh_scheduler_reason_name(refresh_scheduler_reason()));
+}
+
+// Picks up a finished refresh without blocking the loop
+void poll_refresh_results() {
+    static WeatherUpdate update;
+    if (refresh_results && xQueueReceive(refresh_results, &update, 0) == pdTRUE) {
+        refresh_in_flight = false;
+        apply_weather_update(update);
+    }
+}
+
 void setup() {
     Serial.begin(115200);
     Serial.println("ESP32 Weather Station Starting...");
 
     lvgl_init();
     create_ui();
+    create_touch_layer();
+    perf_overlay_create();
 
     // Load configuration from SD card AFTER display init to avoid SPI conflicts
     sd_config_load();
+    load_api_ca_cert();
+    api_build_urls();
+    refresh_scheduler_begin(appConfig.update_interval, appConfig.forecast_interval, appConfig.daily_call_limit);
+
+    // Connects in the background; the first refresh is requested from loop()
+    // once the link is up
+    wifi_link_begin(appConfig.wifi_ssid, appConfig.wifi_password, appConfig.wifi_reuse_ip);
+    start_network_task();
+}
 
-    if (connect_wifi()) {
-        configure_ntp_time();
-        if (fetch_weather()) {
-            fetch_forecast();
+// Follows the WiFi link, which the supervisor keeps reconnecting by itself
+void handle_wifi_link() {
+    switch (wifi_link_poll(millis())) {
+        case WIFI_LINK_CAME_UP:
+            if (!ntp_started) {
+                configure_ntp_time();
+            }
+            hide_status_message();
+            refresh_scheduler_link_up(millis());
+            break;
+        case WIFI_LINK_WENT_DOWN:
+            show_status_message("WiFi lost, reconnecting", 0xFF0000);
+            break;
+        case WIFI_LINK_FAILED:
+            show_status_message("WiFi Failed!", 0xFF0000);
+            break;
+        default:
+            break;
+    }
+}
+
+// Single-character commands from the serial monitor
+void handle_serial_commands() {
+    while (Serial.available() > 0) {
+        int command = Serial.read();
+        switch (command) {
+            case 'p':
+                profiler_print(Serial);
+                break;
+            case 'r':
+                profiler_reset();
+#if ALLOC_TRACE
+                alloc_trace_reset();
+#endif
+                Serial.println("Loop profile reset");
+                break;
+            case 'm':
+                mem_diag_print(Serial);
+                break;
+            case 'o':
+                perf_overlay_toggle();
+                break;
+            case 's':
+                refresh_scheduler_print(Serial, millis());
+                break;
+            case 'w':
+                wifi_link_print(Serial, millis());
+                break;
+            case 'd':
+                wifi_link_drop();
+                break;
+#if ALLOC_TRACE
+            case 'a':
+                alloc_trace_print(Serial);
+                break;
+#endif
+            case '?':
+                Serial.println("Commands: p = print loop profile, r = reset loop profile, m = print memory, "
+                               "o = toggle overlay, s = print refresh schedule");
+                Serial.println("          w = print WiFi link, d = drop WiFi link (reconnect test)");
+#if ALLOC_TRACE
+                Serial.println("          a = print allocation trace");
+#endif
+                break;
+            default:
+                break;
         }
-        update_time_display();
     }
 }
 
 void loop() {
-    lv_timer_handler();
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_LOOP);
+    unsigned long loop_start = micros();
+    {
+        ProfileScope profile(STAGE_LV_TIMER);
+        lv_timer_handler();
+    }
+    // The idle delay is not counted as loop work
+    uint32_t loop_busy_us = static_cast<uint32_t>(micros() - loop_start);
     delay(5);
+    loop_start = micros();
 
     // Update time display every second
     if (millis() - lastTimeUpdate > 1000) {
-        update_time_display();
+        ProfileScope profile(STAGE_TIME_DISPLAY);
+        update_time_display(global_timezone_offset);
         lastTimeUpdate = millis();
     }
 
-    if (millis() - lastUpdate > appConfig.update_interval) {
-        if (fetch_weather()) {
-            fetch_forecast();
-        }
-        lastUpdate = millis();
+    handle_wifi_link();
+    check_ntp_time();
+    // While the link is down a due refresh waits for it instead of failing
+    if (wifi_link_up() && refresh_scheduler_due(millis())) {
+        request_refresh(refresh_scheduler_forecast_due(millis()));
     }
+    poll_refresh_results();
+
+    handle_serial_commands();
+    profiler_record(STAGE_LOOP, loop_busy_us + static_cast<uint32_t>(micros() - loop_start));
 }
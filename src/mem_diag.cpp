@@ -0,0 +1,168 @@
+#include "mem_diag.h"
+
+#include <lvgl.h>
+
+static MemSnapshot phase_snapshots[MEM_PHASE_COUNT];
+static bool phase_marked[MEM_PHASE_COUNT];
+static uint32_t refresh_count = 0;
+// The task that began the refresh owns LVGL; phases marked on other tasks
+// carry the LVGL figures of the previous phase instead of calling into LVGL
+static TaskHandle_t refresh_task = nullptr;
+
+// Worst values over all refreshes
+static uint32_t lowest_free_heap = UINT32_MAX;
+static uint32_t lowest_largest_block = UINT32_MAX;
+static uint32_t lowest_stack_free = UINT32_MAX;
+static uint32_t lowest_fetch_stack_free = UINT32_MAX;
+static uint32_t highest_lv_used = 0;
+static uint32_t first_refresh_free_heap = 0;
+
+// Guards everything above: phases are marked from the network task while
+// the loop task begins, prints and ends refreshes. Snapshots are taken and
+// printed outside it.
+static portMUX_TYPE diag_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *PHASE_NAMES[MEM_PHASE_COUNT] = {
+    "start",
+    "weather response",
+    "weather parsed",
+    "forecast response",
+    "forecast parsed",
+    "rendered",
+};
+
+static void snapshot_heap(MemSnapshot &snapshot) {
+    snapshot.free_heap = ESP.getFreeHeap();
+    snapshot.largest_block = ESP.getMaxAllocHeap();
+    snapshot.min_free_heap = ESP.getMinFreeHeap();
+    snapshot.stack_free = uxTaskGetStackHighWaterMark(nullptr);
+}
+
+void mem_diag_snapshot(MemSnapshot &snapshot) {
+    snapshot_heap(snapshot);
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    snapshot.lv_used = mon.total_size - mon.free_size;
+    snapshot.lv_max_used = mon.max_used;
+    snapshot.lv_free_biggest = mon.free_biggest_size;
+    snapshot.lv_frag_pct = mon.frag_pct;
+}
+
+void mem_diag_begin_refresh() {
+    portENTER_CRITICAL(&diag_mux);
+    for (auto &marked : phase_marked) {
+        marked = false;
+    }
+    refresh_count++;
+    refresh_task = xTaskGetCurrentTaskHandle();
+    portEXIT_CRITICAL(&diag_mux);
+    mem_diag_mark(MEM_PHASE_START);
+    portENTER_CRITICAL(&diag_mux);
+    if (refresh_count == 1) {
+        first_refresh_free_heap = phase_snapshots[MEM_PHASE_START].free_heap;
+    }
+    portEXIT_CRITICAL(&diag_mux);
+}
+
+void mem_diag_mark(MemPhase phase) {
+    if (phase >= MEM_PHASE_COUNT) {
+        return;
+    }
+    MemSnapshot snapshot;
+    portENTER_CRITICAL(&diag_mux);
+    const bool on_refresh_task = xTaskGetCurrentTaskHandle() == refresh_task;
+    if (!on_refresh_task) {
+        int previous = phase - 1;
+        while (previous > MEM_PHASE_START && !phase_marked[previous]) {
+            previous--;
+        }
+        snapshot = phase_snapshots[previous];
+    }
+    portEXIT_CRITICAL(&diag_mux);
+    if (on_refresh_task) {
+        mem_diag_snapshot(snapshot);
+    } else {
+        snapshot_heap(snapshot);
+    }
+
+    portENTER_CRITICAL(&diag_mux);
+    phase_snapshots[phase] = snapshot;
+    phase_marked[phase] = true;
+    lowest_free_heap = min(lowest_free_heap, snapshot.free_heap);
+    lowest_largest_block = min(lowest_largest_block, snapshot.largest_block);
+    if (on_refresh_task) {
+        lowest_stack_free = min(lowest_stack_free, snapshot.stack_free);
+    } else {
+        lowest_fetch_stack_free = min(lowest_fetch_stack_free, snapshot.stack_free);
+    }
+    highest_lv_used = max(highest_lv_used, snapshot.lv_used);
+    portEXIT_CRITICAL(&diag_mux);
+}
+
+static void print_header(Print &out) {
+    out.printf("%-17s %8s %8s %8s %8s %5s %7s\n", "phase", "free", "largest", "min_free", "lv_used", "frag",
+               "stack");
+}
+
+static void print_snapshot(Print &out, const char *name, const MemSnapshot &snapshot) {
+    out.printf("%-17s %8lu %8lu %8lu %8lu %4u%% %7lu\n", name, (unsigned long)snapshot.free_heap,
+               (unsigned long)snapshot.largest_block, (unsigned long)snapshot.min_free_heap,
+               (unsigned long)snapshot.lv_used, snapshot.lv_frag_pct, (unsigned long)snapshot.stack_free);
+}
+
+void mem_diag_end_refresh(Print &out) {
+    MemSnapshot snapshots[MEM_PHASE_COUNT];
+    bool marked[MEM_PHASE_COUNT];
+    portENTER_CRITICAL(&diag_mux);
+    memcpy(snapshots, phase_snapshots, sizeof(snapshots));
+    memcpy(marked, phase_marked, sizeof(marked));
+    const uint32_t count = refresh_count;
+    const uint32_t first_free_heap = first_refresh_free_heap;
+    portEXIT_CRITICAL(&diag_mux);
+
+    out.printf("Memory, refresh #%lu (bytes):\n", (unsigned long)count);
+    print_header(out);
+    for (int i = 0; i < MEM_PHASE_COUNT; ++i) {
+        if (marked[i]) {
+            print_snapshot(out, PHASE_NAMES[i], snapshots[i]);
+        }
+    }
+    // A start-of-refresh free heap that keeps sinking points at a leak;
+    // a largest block falling faster than the free heap at fragmentation
+    const long drift = (long)snapshots[MEM_PHASE_START].free_heap - (long)first_free_heap;
+    out.printf("Free heap at start vs first refresh: %+ld\n\n", drift);
+}
+
+void mem_diag_print(Print &out) {
+    MemSnapshot now;
+    mem_diag_snapshot(now);
+    portENTER_CRITICAL(&diag_mux);
+    const uint32_t count = refresh_count;
+    const uint32_t free_heap = lowest_free_heap;
+    const uint32_t largest_block = lowest_largest_block;
+    const uint32_t lv_used = highest_lv_used;
+    const uint32_t stack_free = lowest_stack_free;
+    const uint32_t fetch_stack_free = lowest_fetch_stack_free;
+    portEXIT_CRITICAL(&diag_mux);
+
+    out.println("=========================================");
+    out.println("Memory (bytes)");
+    out.println("=========================================");
+    out.printf("Heap size: %lu, LVGL pool: %lu\n", (unsigned long)ESP.getHeapSize(), (unsigned long)LV_MEM_SIZE);
+    print_header(out);
+    print_snapshot(out, "now", now);
+    if (count > 0) {
+        out.printf("Worst over %lu refreshes: free %lu, largest %lu, lv_used %lu (peak %lu), stack %lu\n",
+                   (unsigned long)count, (unsigned long)free_heap, (unsigned long)largest_block,
+                   (unsigned long)lv_used, (unsigned long)now.lv_max_used, (unsigned long)stack_free);
+        if (fetch_stack_free != UINT32_MAX) {
+            out.printf("Network task stack never used: %lu\n", (unsigned long)fetch_stack_free);
+        }
+    }
+    out.println("=========================================\n");
+}
+
+const char *mem_diag_phase_name(MemPhase phase) {
+    return phase < MEM_PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
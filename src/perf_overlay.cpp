@@ -0,0 +1,87 @@
+#include "perf_overlay.h"
+
+#include <Arduino.h>
+
+#include "loop_profiler.h"
+
+static lv_obj_t *overlay_label = nullptr;
+static lv_timer_t *overlay_timer = nullptr;
+
+// Frames rendered since the last overlay update
+static uint32_t frame_count = 0;
+static uint32_t frame_render_ms = 0;
+static uint32_t window_start_ms = 0;
+
+void perf_overlay_monitor_cb(lv_disp_drv_t *drv, uint32_t time_ms, uint32_t px) {
+    LV_UNUSED(drv);
+    LV_UNUSED(px);
+    frame_count++;
+    frame_render_ms += time_ms;
+}
+
+static void update_overlay(lv_timer_t *timer) {
+    LV_UNUSED(timer);
+    const uint32_t now = lv_tick_get();
+    const uint32_t elapsed = now - window_start_ms;
+    const uint32_t fps = elapsed > 0 ? (frame_count * 1000 + elapsed / 2) / elapsed : 0;
+    const uint32_t render_ms = frame_count > 0 ? frame_render_ms / frame_count : 0;
+    frame_count = 0;
+    frame_render_ms = 0;
+    window_start_ms = now;
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+
+    ProfileSummary flush = {};
+    profiler_summary(STAGE_DISP_FLUSH, flush);
+
+    lv_label_set_text_fmt(overlay_label,
+                          "%lu FPS  CPU %u%%  render %lums\n"
+                          "flush avg %lu max %lu us\n"
+                          "lv_mem %lu/%luk  frag %u%%\n"
+                          "fetch W %lums  F %lums",
+                          (unsigned long)fps, 100 - lv_timer_get_idle(), (unsigned long)render_ms,
+                          (unsigned long)flush.avg_us, (unsigned long)flush.max_us,
+                          (unsigned long)((mon.total_size - mon.free_size) / 1024),
+                          (unsigned long)(mon.total_size / 1024), mon.frag_pct,
+                          (unsigned long)(profiler_last_us(STAGE_FETCH_WEATHER) / 1000),
+                          (unsigned long)(profiler_last_us(STAGE_FETCH_FORECAST) / 1000));
+}
+
+void perf_overlay_create() {
+    overlay_label = lv_label_create(lv_layer_top());
+    lv_label_set_text(overlay_label, "");
+    lv_obj_set_style_text_color(overlay_label, lv_color_hex(0x55FF55), 0);
+    lv_obj_set_style_text_font(overlay_label, &lv_font_montserrat_12, 0);
+    lv_obj_set_style_bg_color(overlay_label, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_opa(overlay_label, LV_OPA_80, 0);
+    lv_obj_set_style_pad_all(overlay_label, 4, 0);
+    lv_obj_align(overlay_label, LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_obj_add_flag(overlay_label, LV_OBJ_FLAG_HIDDEN);
+
+    overlay_timer = lv_timer_create(update_overlay, PERF_OVERLAY_PERIOD_MS, NULL);
+    lv_timer_pause(overlay_timer);
+}
+
+void perf_overlay_toggle() {
+    if (!overlay_label) {
+        return;
+    }
+    if (perf_overlay_visible()) {
+        lv_obj_add_flag(overlay_label, LV_OBJ_FLAG_HIDDEN);
+        lv_timer_pause(overlay_timer);
+        Serial.println("Performance overlay off");
+        return;
+    }
+    frame_count = 0;
+    frame_render_ms = 0;
+    window_start_ms = lv_tick_get();
+    update_overlay(overlay_timer);
+    lv_obj_clear_flag(overlay_label, LV_OBJ_FLAG_HIDDEN);
+    lv_timer_resume(overlay_timer);
+    Serial.println("Performance overlay on");
+}
+
+bool perf_overlay_visible() {
+    return overlay_label && !lv_obj_has_flag(overlay_label, LV_OBJ_FLAG_HIDDEN);
+}
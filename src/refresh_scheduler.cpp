@@ -0,0 +1,183 @@
+#include "refresh_scheduler.h"
+
+#include "weather_parse.h"
+
+static const uint32_t SECONDS_PER_DAY = 86400;
+
+static uint32_t base_interval_ms = 0;
+static uint32_t forecast_interval_ms = 0;
+static uint32_t call_limit = 0;
+
+static uint32_t last_finish_ms = 0;
+static uint32_t next_delay_ms = 0;
+static ScheduleReason reason = SCHEDULE_START;
+static uint32_t consecutive_failures = 0;
+static RefreshOutcome last_outcome = REFRESH_OK;
+static bool forecast_received = false;
+static uint32_t last_forecast_ms = 0;
+
+// Calls of the current day. Until NTP has set the clock, days are counted
+// from boot; the count carries over when the clock becomes valid.
+static uint32_t calls_today = 0;
+static long day_number = -1;
+static bool day_from_clock = false;
+static uint8_t calls_per_refresh = 1;
+
+static const char *REASON_NAMES[] = {
+    "start",
+    "normal",
+    "weather changing fast",
+    "retry after failure",
+    "daily budget",
+    "daily limit reached",
+    "WiFi reconnected",
+};
+
+static uint32_t seconds_until_day_end(uint32_t now_ms, time_t now_utc) {
+    if (now_utc >= CLOCK_VALID_AFTER) {
+        return SECONDS_PER_DAY - static_cast<uint32_t>(now_utc % SECONDS_PER_DAY);
+    }
+    return SECONDS_PER_DAY - (now_ms / 1000) % SECONDS_PER_DAY;
+}
+
+static void update_day(uint32_t now_ms, time_t now_utc) {
+    const bool clock_valid = now_utc >= CLOCK_VALID_AFTER;
+    const long day = clock_valid ? static_cast<long>(now_utc / SECONDS_PER_DAY)
+                                 : static_cast<long>(now_ms / 1000 / SECONDS_PER_DAY);
+    if (clock_valid && !day_from_clock) {
+        day_from_clock = true;
+    } else if (day != day_number) {
+        calls_today = 0;
+    }
+    day_number = day;
+}
+
+// +-REFRESH_JITTER_PERCENT, or only later when the delay must not end early
+static uint32_t apply_jitter(uint32_t delay_ms, bool only_later) {
+    const long span = static_cast<long>(delay_ms / 100 * REFRESH_JITTER_PERCENT);
+    if (span <= 0) {
+        return delay_ms;
+    }
+    const long offset = only_later ? random(0, span + 1) : random(-span, span + 1);
+    return static_cast<uint32_t>(static_cast<long>(delay_ms) + offset);
+}
+
+void refresh_scheduler_begin(uint32_t base_interval, uint32_t forecast_interval, uint32_t daily_call_limit) {
+    base_interval_ms = base_interval;
+    forecast_interval_ms = forecast_interval;
+    call_limit = daily_call_limit;
+    next_delay_ms = 0;
+    reason = SCHEDULE_START;
+}
+
+bool refresh_scheduler_due(uint32_t now_ms) {
+    return now_ms - last_finish_ms >= next_delay_ms;
+}
+
+bool refresh_scheduler_forecast_due(uint32_t now_ms) {
+    return !forecast_received || now_ms - last_forecast_ms >= forecast_interval_ms;
+}
+
+void refresh_scheduler_finished(uint32_t now_ms, time_t now_utc, RefreshOutcome outcome, uint8_t api_calls,
+                                bool forecast_updated, bool changing_fast) {
+    if (forecast_updated) {
+        forecast_received = true;
+        last_forecast_ms = now_ms;
+    }
+    update_day(now_ms, now_utc);
+    calls_today += api_calls;
+    if (api_calls > 0) {
+        calls_per_refresh = api_calls;
+    }
+
+    uint32_t delay_ms = base_interval_ms;
+    reason = SCHEDULE_NORMAL;
+    if (outcome == REFRESH_OK) {
+        consecutive_failures = 0;
+        if (changing_fast && static_cast<uint32_t>(REFRESH_FAST_INTERVAL_MS) < base_interval_ms) {
+            delay_ms = REFRESH_FAST_INTERVAL_MS;
+            reason = SCHEDULE_FAST;
+        }
+    } else {
+        // The backoff starts over when the kind of failure changes
+        consecutive_failures = outcome == last_outcome ? consecutive_failures + 1 : 1;
+        const uint32_t shift = min(consecutive_failures - 1, static_cast<uint32_t>(16));
+        // A network failure costs nothing, so it never waits longer than a
+        // normal refresh; a failing API is backed off further
+        const uint32_t cap = outcome == REFRESH_NETWORK_ERROR
+                                 ? base_interval_ms
+                                 : max(base_interval_ms, static_cast<uint32_t>(REFRESH_BACKOFF_MAX_MS));
+        delay_ms = min(static_cast<uint32_t>(REFRESH_RETRY_MIN_MS) << shift, cap);
+        reason = SCHEDULE_RETRY;
+    }
+
+    bool only_later = false;
+    if (call_limit > 0) {
+        const uint32_t seconds_left = seconds_until_day_end(now_ms, now_utc);
+        if (calls_today + calls_per_refresh > call_limit) {
+            delay_ms = seconds_left * 1000;
+            reason = SCHEDULE_QUOTA_EXHAUSTED;
+            only_later = true;
+        } else {
+            // Spread the calls that are left evenly over the rest of the day
+            const uint32_t refreshes_left = (call_limit - calls_today) / calls_per_refresh;
+            const uint64_t paced_ms = static_cast<uint64_t>(seconds_left) * 1000 / refreshes_left;
+            if (paced_ms > delay_ms) {
+                delay_ms = static_cast<uint32_t>(paced_ms);
+                reason = SCHEDULE_BUDGET;
+            }
+        }
+    }
+
+    last_outcome = outcome;
+    last_finish_ms = now_ms;
+    next_delay_ms = apply_jitter(delay_ms, only_later);
+}
+
+void refresh_scheduler_link_up(uint32_t now_ms) {
+    // API errors and the daily budget keep their delay
+    if (reason == SCHEDULE_RETRY && last_outcome == REFRESH_NETWORK_ERROR) {
+        last_finish_ms = now_ms;
+        next_delay_ms = 0;
+        reason = SCHEDULE_LINK_UP;
+    }
+}
+
+uint32_t refresh_scheduler_next_delay_ms() {
+    return next_delay_ms;
+}
+
+ScheduleReason refresh_scheduler_reason() {
+    return reason;
+}
+
+const char *refresh_scheduler_reason_name(ScheduleReason schedule_reason) {
+    if (schedule_reason > SCHEDULE_LINK_UP) {
+        return "?";
+    }
+    return REASON_NAMES[schedule_reason];
+}
+
+void refresh_scheduler_print(Print &out, uint32_t now_ms) {
+    const uint32_t elapsed_ms = now_ms - last_finish_ms;
+    const uint32_t remaining_ms = elapsed_ms >= next_delay_ms ? 0 : next_delay_ms - elapsed_ms;
+    out.println("=========================================");
+    out.println("Refresh schedule");
+    out.println("=========================================");
+    out.printf("Next refresh in %lu s (%s)\n", (unsigned long)(remaining_ms / 1000), refresh_scheduler_reason_name(reason));
+    out.printf("Interval: %lu s, consecutive failures: %lu\n", (unsigned long)(base_interval_ms / 1000),
+               (unsigned long)consecutive_failures);
+    if (forecast_received) {
+        out.printf("Forecast: every %lu s, last updated %lu s ago\n", (unsigned long)(forecast_interval_ms / 1000),
+                   (unsigned long)((now_ms - last_forecast_ms) / 1000));
+    } else {
+        out.printf("Forecast: every %lu s, not received yet\n", (unsigned long)(forecast_interval_ms / 1000));
+    }
+    if (call_limit > 0) {
+        out.printf("API calls today: %lu of %lu (%u per refresh)\n", (unsigned long)calls_today,
+                   (unsigned long)call_limit, calls_per_refresh);
+    } else {
+        out.printf("API calls today: %lu (no daily limit)\n", (unsigned long)calls_today);
+    }
+    out.println("=========================================\n");
+}
@@ -0,0 +1,352 @@
+#include "tls_client.h"
+
+// The native build implements TlsClient on OpenSSL (native/tls_client_openssl.cpp)
+#if !NATIVE_BUILD
+
+#include <fcntl.h>
+#include <lwip/sockets.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/version.h>
+
+// Resumption is detected from mbedtls_ssl_session.master, a public field up to
+// mbedtls 2.28 (the platform pinned in platformio.ini) and a private one in 3
+#if MBEDTLS_VERSION_MAJOR >= 3
+#error "TlsClient reads mbedtls_ssl_session.master, which is private in mbedtls 3"
+#endif
+
+struct TlsClient::Tls {
+    // Set up by the first secure connection and kept for the life of the
+    // client, so later handshakes neither seed the DRBG nor parse the CA
+    // certificates again
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_x509_crt ca;
+    mbedtls_ssl_config conf;
+    bool configured = false;
+    mbedtls_ssl_context ssl;
+    mbedtls_net_context net;
+    bool open = false;
+    // Outlives the connections: the session to resume next time
+    mbedtls_ssl_session session;
+    bool has_session = false;
+
+    int configure(const char *ca_pem);
+    void unconfigure();
+};
+
+// Without ca_pem the server is not verified
+int TlsClient::Tls::configure(const char *ca_pem) {
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_ssl_config_init(&conf);
+    configured = true;
+
+    int ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, nullptr, 0);
+    if (ret == 0) {
+        ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret == 0 && ca_pem) {
+        ret = mbedtls_x509_crt_parse(&ca, reinterpret_cast<const unsigned char *>(ca_pem), strlen(ca_pem) + 1);
+    }
+    if (ret != 0) {
+        unconfigure();
+        return ret;
+    }
+    if (ca_pem) {
+        mbedtls_ssl_conf_ca_chain(&conf, &ca, nullptr);
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    } else {
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+    }
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    return 0;
+}
+
+void TlsClient::Tls::unconfigure() {
+    if (!configured) {
+        return;
+    }
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_x509_crt_free(&ca);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+    configured = false;
+}
+
+TlsClient::TlsClient() : _tls(new Tls) {
+    _server_name[0] = '\0';
+    mbedtls_ssl_session_init(&_tls->session);
+}
+
+TlsClient::~TlsClient() {
+    stop();
+    _tls->unconfigure();
+    mbedtls_ssl_session_free(&_tls->session);
+    delete _tls;
+}
+
+void TlsClient::setSecure(bool secure) {
+    stop();
+    _secure = secure;
+}
+
+void TlsClient::setServerName(const char *name) {
+    strncpy(_server_name, name ? name : "", sizeof(_server_name) - 1);
+    _server_name[sizeof(_server_name) - 1] = '\0';
+}
+
+// A different CA means a new configuration, and a session saved under the
+// old one must not be resumed: resuming skips verifying the server
+void TlsClient::setCACert(const char *pem) {
+    if (pem == _ca_pem && !_insecure) {
+        return;
+    }
+    stop();
+    _tls->unconfigure();
+    forgetSession();
+    _ca_pem = pem;
+    _insecure = false;
+}
+
+void TlsClient::setInsecure() {
+    if (_insecure) {
+        return;
+    }
+    stop();
+    _tls->unconfigure();
+    forgetSession();
+    _ca_pem = nullptr;
+    _insecure = true;
+}
+
+void TlsClient::forgetSession() {
+    mbedtls_ssl_session_free(&_tls->session);
+    mbedtls_ssl_session_init(&_tls->session);
+    _tls->has_session = false;
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port) {
+    if (!WiFiClient::connect(ip, port)) {
+        return 0;
+    }
+    return !_secure || startTls(_server_name) ? 1 : 0;
+}
+
+int TlsClient::connect(const char *host, uint16_t port) {
+    if (!WiFiClient::connect(host, port)) {
+        return 0;
+    }
+    return !_secure || startTls(_server_name[0] != '\0' ? _server_name : host) ? 1 : 0;
+}
+
+// A resumed session carries on with the master secret of the saved one; a
+// full handshake derives a new one. (The session ID is no proof: the client
+// makes up a fresh one when it offers a ticket.)
+static bool same_master_secret(const mbedtls_ssl_session &a, const mbedtls_ssl_session &b) {
+    return memcmp(a.master, b.master, sizeof(a.master)) == 0;
+}
+
+bool TlsClient::startTls(const char *host) {
+    Tls &tls = *_tls;
+    const uint32_t started = millis();
+    _resumed = false;
+    if (!_ca_pem && !_insecure) {
+        Serial.printf("TLS: no CA certificate for %s, not connecting unverified\n", host);
+        WiFiClient::stop();
+        return false;
+    }
+
+    int ret = tls.configured ? 0 : tls.configure(_ca_pem);
+    if (ret != 0) {
+        Serial.printf("TLS setup failed: -0x%04x\n", -ret);
+        WiFiClient::stop();
+        return false;
+    }
+    mbedtls_ssl_init(&tls.ssl);
+    mbedtls_net_init(&tls.net);
+    tls.open = true;
+
+    ret = mbedtls_ssl_setup(&tls.ssl, &tls.conf);
+    if (ret == 0) {
+        ret = mbedtls_ssl_set_hostname(&tls.ssl, host);
+    }
+    if (ret == 0 && tls.has_session) {
+        ret = mbedtls_ssl_set_session(&tls.ssl, &tls.session);
+    }
+    if (ret != 0) {
+        Serial.printf("TLS setup failed: -0x%04x\n", -ret);
+        stop();
+        return false;
+    }
+
+    // The TCP socket of the base class carries the records; non-blocking so
+    // reads can be polled like a plain WiFiClient
+    tls.net.fd = WiFiClient::fd();
+    fcntl(tls.net.fd, F_SETFL, fcntl(tls.net.fd, F_GETFL, 0) | O_NONBLOCK);
+    mbedtls_ssl_set_bio(&tls.ssl, &tls.net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+    while ((ret = mbedtls_ssl_handshake(&tls.ssl)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            break;
+        }
+        if (millis() - started > TLS_HANDSHAKE_TIMEOUT_MS) {
+            ret = MBEDTLS_ERR_SSL_TIMEOUT;
+            break;
+        }
+        delay(2);
+    }
+    if (ret != 0) {
+        Serial.printf("TLS handshake with %s failed: -0x%04x\n", host, -ret);
+        // The saved session may be what the server rejected
+        forgetSession();
+        stop();
+        return false;
+    }
+
+    mbedtls_ssl_session current;
+    mbedtls_ssl_session_init(&current);
+    if (mbedtls_ssl_get_session(&tls.ssl, &current) == 0) {
+        _resumed = tls.has_session && same_master_secret(current, tls.session);
+        mbedtls_ssl_session_free(&tls.session);
+        tls.session = current;
+        tls.has_session = true;
+    } else {
+        mbedtls_ssl_session_free(&current);
+    }
+    _handshake_ms = millis() - started;
+    return true;
+}
+
+void TlsClient::stopTls() {
+    Tls &tls = *_tls;
+    if (!tls.open) {
+        return;
+    }
+    // The socket itself belongs to the base class; the configuration is kept
+    tls.net.fd = -1;
+    mbedtls_ssl_free(&tls.ssl);
+    tls.open = false;
+}
+
+void TlsClient::stop() {
+    if (_tls->open && WiFiClient::connected()) {
+        mbedtls_ssl_close_notify(&_tls->ssl);
+    }
+    stopTls();
+    WiFiClient::stop();
+}
+
+uint8_t TlsClient::connected() {
+    if (!_secure) {
+        return WiFiClient::connected();
+    }
+    return _tls->open && (mbedtls_ssl_get_bytes_avail(&_tls->ssl) > 0 || WiFiClient::connected());
+}
+
+int TlsClient::available() {
+    if (!_secure) {
+        return WiFiClient::available();
+    }
+    if (!_tls->open) {
+        return 0;
+    }
+    // A zero-length read processes whatever records have arrived
+    int ret = mbedtls_ssl_read(&_tls->ssl, nullptr, 0);
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+        stop();
+        return 0;
+    }
+    return static_cast<int>(mbedtls_ssl_get_bytes_avail(&_tls->ssl));
+}
+
+int TlsClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int TlsClient::read(uint8_t *buf, size_t size) {
+    if (!_secure) {
+        return WiFiClient::read(buf, size);
+    }
+    if (!_tls->open) {
+        return -1;
+    }
+    int ret = mbedtls_ssl_read(&_tls->ssl, buf, size);
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        return -1;
+    }
+    if (ret <= 0) {
+        // Close notify or a broken connection
+        stop();
+        return -1;
+    }
+    return ret;
+}
+
+size_t TlsClient::readBytes(char *buffer, size_t length) {
+    if (!_secure) {
+        return WiFiClient::readBytes(buffer, length);
+    }
+    size_t count = 0;
+    const uint32_t started = millis();
+    while (count < length && millis() - started < _timeout) {
+        int got = read(reinterpret_cast<uint8_t *>(buffer) + count, length - count);
+        if (got > 0) {
+            count += got;
+        } else if (!_tls->open) {
+            break;
+        } else {
+            delay(1);
+        }
+    }
+    return count;
+}
+
+int TlsClient::peek() {
+    if (!_secure) {
+        return WiFiClient::peek();
+    }
+    // mbedtls cannot peek; only called between responses, where nothing is pending
+    return -1;
+}
+
+size_t TlsClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t TlsClient::write(const uint8_t *buf, size_t size) {
+    if (!_secure) {
+        return WiFiClient::write(buf, size);
+    }
+    if (!_tls->open) {
+        return 0;
+    }
+    size_t written = 0;
+    const uint32_t started = millis();
+    while (written < size) {
+        int ret = mbedtls_ssl_write(&_tls->ssl, buf + written, size - written);
+        if (ret > 0) {
+            written += ret;
+        } else if ((ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) &&
+                   millis() - started < _timeout) {
+            delay(1);
+        } else {
+            break;
+        }
+    }
+    return written;
+}
+
+void TlsClient::flush() {
+    if (!_secure) {
+        WiFiClient::flush();
+    }
+}
+
+#endif
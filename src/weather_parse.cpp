@@ -0,0 +1,331 @@
+#include "weather_parse.h"
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+
+const char *DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+void copy_text(char *dest, size_t size, const char *src) {
+    if (size == 0) {
+        return;
+    }
+    size_t length = src ? strnlen(src, size - 1) : 0;
+    if (length > 0) {
+        memcpy(dest, src, length);
+    }
+    dest[length] = '\0';
+}
+
+void format_update_time(long epoch_seconds, long timezone_offset_seconds, char *out, size_t size) {
+    out[0] = '\0';
+    if (epoch_seconds <= 0) {
+        return;
+    }
+
+    time_t adjusted_time = static_cast<time_t>(epoch_seconds + timezone_offset_seconds);
+    struct tm timeinfo;
+    if (!gmtime_r(&adjusted_time, &timeinfo)) {
+        return;
+    }
+
+    if (strftime(out, size, "%H:%M", &timeinfo) == 0) {
+        out[0] = '\0';
+    }
+}
+
+void reset_forecast_entries(ForecastEntry *entries, int count) {
+    for (int i = 0; i < count; ++i) {
+        ForecastEntry &entry = entries[i];
+        entry.valid = false;
+        entry.day[0] = '\0';
+        copy_text(entry.icon, sizeof(entry.icon), "01d");
+        entry.temp_max = 0.0f;
+        entry.temp_min = 0.0f;
+    }
+}
+
+bool forecast_entries_equal(const ForecastEntry *a, const ForecastEntry *b, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (a[i].valid != b[i].valid || a[i].temp_min != b[i].temp_min || a[i].temp_max != b[i].temp_max ||
+            strcmp(a[i].day, b[i].day) != 0 || strcmp(a[i].icon, b[i].icon) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool weather_changed_fast(const WeatherData &before, const WeatherData &after) {
+    // The icon without its day/night suffix: "10d" and "10n" are both rain
+    if (strncmp(before.icon, after.icon, 2) != 0) {
+        return true;
+    }
+    return fabsf(after.temperature - before.temperature) >= WEATHER_FAST_TEMP_DELTA ||
+           abs(after.humidity - before.humidity) >= WEATHER_FAST_HUMIDITY_DELTA;
+}
+
+// Filter members are string literals, stored by pointer: the documents only
+// hold the slots
+static StaticJsonDocument<256 * JSON_CAPACITY_SCALE> weather_filter_doc;
+static StaticJsonDocument<256 * JSON_CAPACITY_SCALE> forecast_filter_doc;
+static StaticJsonDocument<512 * JSON_CAPACITY_SCALE> onecall_filter_doc;
+
+// The elements of an array are filtered by its first element
+static void add_conditions_filter(JsonObject parent, bool with_description) {
+    JsonObject condition = parent.createNestedArray("weather").createNestedObject();
+    condition["icon"] = true;
+    if (with_description) {
+        condition["description"] = true;
+    }
+}
+
+const JsonDocument &current_weather_filter() {
+    if (weather_filter_doc.isNull()) {
+        JsonObject main = weather_filter_doc.createNestedObject("main");
+        main["temp"] = true;
+        main["feels_like"] = true;
+        main["humidity"] = true;
+        add_conditions_filter(weather_filter_doc.as<JsonObject>(), true);
+        weather_filter_doc["name"] = true;
+        weather_filter_doc["dt"] = true;
+        weather_filter_doc["timezone"] = true;
+        JsonObject coord = weather_filter_doc.createNestedObject("coord");
+        coord["lat"] = true;
+        coord["lon"] = true;
+    }
+    return weather_filter_doc;
+}
+
+const JsonDocument &forecast_filter() {
+    if (forecast_filter_doc.isNull()) {
+        JsonObject slot = forecast_filter_doc.createNestedArray("list").createNestedObject();
+        slot["dt"] = true;
+        JsonObject main = slot.createNestedObject("main");
+        main["temp_min"] = true;
+        main["temp_max"] = true;
+        add_conditions_filter(slot, false);
+        forecast_filter_doc["city"]["timezone"] = true;
+    }
+    return forecast_filter_doc;
+}
+
+const JsonDocument &onecall_filter() {
+    if (onecall_filter_doc.isNull()) {
+        onecall_filter_doc["lat"] = true;
+        onecall_filter_doc["lon"] = true;
+        onecall_filter_doc["timezone_offset"] = true;
+        JsonObject current = onecall_filter_doc.createNestedObject("current");
+        current["dt"] = true;
+        current["temp"] = true;
+        current["feels_like"] = true;
+        current["humidity"] = true;
+        add_conditions_filter(current, true);
+        JsonObject day = onecall_filter_doc.createNestedArray("daily").createNestedObject();
+        day["dt"] = true;
+        JsonObject temp = day.createNestedObject("temp");
+        temp["min"] = true;
+        temp["max"] = true;
+        add_conditions_filter(day, false);
+    }
+    return onecall_filter_doc;
+}
+
+long parse_current_weather(JsonDocument &doc, WeatherData &out) {
+    out.temperature = doc["main"]["temp"];
+    out.feels_like = doc["main"]["feels_like"];
+    out.humidity = doc["main"]["humidity"];
+    copy_text(out.description, sizeof(out.description), doc["weather"][0]["description"] | "");
+    copy_text(out.icon, sizeof(out.icon), doc["weather"][0]["icon"] | "");
+    copy_text(out.city, sizeof(out.city), doc["name"] | "");
+    long update_epoch = doc["dt"] | 0L;
+    long timezone_offset = doc["timezone"] | 0L;
+    out.observed_at = update_epoch;
+    out.latitude = doc["coord"]["lat"] | 0.0f;
+    out.longitude = doc["coord"]["lon"] | 0.0f;
+    format_update_time(update_epoch, timezone_offset, out.last_update_time, sizeof(out.last_update_time));
+    return timezone_offset;
+}
+
+int forecast_slot_count(time_t now_utc, long timezone_offset, int days) {
+    if (now_utc < CLOCK_VALID_AFTER) {
+        return FORECAST_MAX_SLOTS;
+    }
+    // End of the last displayed day in local time, back in UTC
+    const time_t local_now = now_utc + timezone_offset;
+    const time_t local_end = (local_now / 86400 + 1 + days) * 86400;
+    const time_t seconds = local_end - local_now;
+    // The first slot may start up to one slot before now
+    int slots = static_cast<int>((seconds + FORECAST_SLOT_SECONDS - 1) / FORECAST_SLOT_SECONDS) + 1;
+    return slots < FORECAST_MAX_SLOTS ? slots : FORECAST_MAX_SLOTS;
+}
+
+size_t forecast_json_capacity(int slots) {
+    size_t capacity = FORECAST_JSON_BASE_CAPACITY + static_cast<size_t>(slots) * FORECAST_SLOT_JSON_CAPACITY;
+    return capacity < FORECAST_JSON_CAPACITY ? capacity : FORECAST_JSON_CAPACITY;
+}
+
+long parse_onecall_current(JsonDocument &doc, WeatherData &out) {
+    JsonObject current = doc["current"];
+    out.temperature = current["temp"];
+    out.feels_like = current["feels_like"];
+    out.humidity = current["humidity"];
+    copy_text(out.description, sizeof(out.description), current["weather"][0]["description"] | "");
+    copy_text(out.icon, sizeof(out.icon), current["weather"][0]["icon"] | "");
+    long update_epoch = current["dt"] | 0L;
+    long timezone_offset = doc["timezone_offset"] | 0L;
+    out.observed_at = update_epoch;
+    out.latitude = doc["lat"] | out.latitude;
+    out.longitude = doc["lon"] | out.longitude;
+    format_update_time(update_epoch, timezone_offset, out.last_update_time, sizeof(out.last_update_time));
+    return timezone_offset;
+}
+
+int parse_onecall_daily(JsonDocument &doc, time_t now_utc, ForecastEntry *entries, int max_days) {
+    reset_forecast_entries(entries, max_days);
+    if (max_days > FORECAST_DAYS) {
+        max_days = FORECAST_DAYS;
+    }
+    long timezone_offset = doc["timezone_offset"] | 0L;
+    int current_yday = -1;
+    if (now_utc >= CLOCK_VALID_AFTER) {
+        time_t local_now = now_utc + timezone_offset;
+        struct tm now_info;
+        if (gmtime_r(&local_now, &now_info)) {
+            current_yday = now_info.tm_yday;
+        }
+    }
+
+    int day_count = 0;
+    for (JsonVariant day : doc["daily"].as<JsonArray>()) {
+        if (day_count >= max_days) {
+            break;
+        }
+        time_t timestamp = static_cast<time_t>((day["dt"] | 0L) + timezone_offset);
+        struct tm timeinfo;
+        if (!gmtime_r(&timestamp, &timeinfo) || timeinfo.tm_yday == current_yday) {
+            continue;
+        }
+        ForecastEntry &entry = entries[day_count++];
+        copy_text(entry.day, sizeof(entry.day), DAY_NAMES[timeinfo.tm_wday]);
+        entry.temp_min = day["temp"]["min"] | 0.0f;
+        entry.temp_max = day["temp"]["max"] | 0.0f;
+        const char *icon = day["weather"][0]["icon"] | "";
+        copy_text(entry.icon, sizeof(entry.icon), icon[0] != '\0' ? icon : "01d");
+        entry.valid = true;
+    }
+    return day_count;
+}
+
+int aggregate_forecast(JsonDocument &doc, time_t now_utc, ForecastEntry *entries, int max_days) {
+    reset_forecast_entries(entries, max_days);
+    JsonArray list = doc["list"].as<JsonArray>();
+    long timezone_offset = doc["city"]["timezone"] | 0L;
+    int current_yday = -1;
+    if (now_utc >= CLOCK_VALID_AFTER) {
+        time_t local_now = now_utc + timezone_offset;
+        struct tm now_info;
+        if (gmtime_r(&local_now, &now_info)) {
+            current_yday = now_info.tm_yday;
+        }
+    }
+
+    struct DailyAccumulator {
+        int yday;
+        int weekday;
+        float min_temp;
+        float max_temp;
+        bool has_values;
+        char icon[8];
+        int icon_score;
+    };
+
+    DailyAccumulator day_data[FORECAST_DAYS];
+    int day_count = 0;
+    if (max_days > FORECAST_DAYS) {
+        max_days = FORECAST_DAYS;
+    }
+
+    if (!list.isNull()) {
+        for (JsonVariant value : list) {
+            long raw_timestamp = value["dt"] | 0L;
+            time_t timestamp = static_cast<time_t>(raw_timestamp + timezone_offset);
+            struct tm timeinfo;
+            if (!gmtime_r(&timestamp, &timeinfo)) {
+                continue;
+            }
+
+            if (current_yday != -1 && timeinfo.tm_yday == current_yday) {
+                continue;
+            }
+
+            int idx = -1;
+            for (int i = 0; i < day_count; ++i) {
+                if (day_data[i].yday == timeinfo.tm_yday) {
+                    idx = i;
+                    break;
+                }
+            }
+
+            if (idx == -1) {
+                if (day_count >= max_days) {
+                    continue;
+                }
+                idx = day_count;
+                day_data[idx].yday = timeinfo.tm_yday;
+                day_data[idx].weekday = timeinfo.tm_wday;
+                day_data[idx].min_temp = FLT_MAX;
+                day_data[idx].max_temp = -FLT_MAX;
+                day_data[idx].has_values = false;
+                day_data[idx].icon[0] = '\0';
+                day_data[idx].icon_score = INT_MAX;
+                day_count++;
+            }
+
+            float temp_min = value["main"]["temp_min"] | 0.0f;
+            float temp_max = value["main"]["temp_max"] | temp_min;
+            if (!day_data[idx].has_values) {
+                day_data[idx].min_temp = temp_min;
+                day_data[idx].max_temp = temp_max;
+                day_data[idx].has_values = true;
+            } else {
+                day_data[idx].min_temp = min(day_data[idx].min_temp, temp_min);
+                day_data[idx].max_temp = max(day_data[idx].max_temp, temp_max);
+            }
+
+            const char *icon = value["weather"][0]["icon"] | "";
+            if (icon[0] == '\0') {
+                icon = "01d";
+            }
+            int hour = timeinfo.tm_hour;
+            int score = abs(hour - 12);
+            if (day_data[idx].icon[0] == '\0' || score < day_data[idx].icon_score) {
+                copy_text(day_data[idx].icon, sizeof(day_data[idx].icon), icon);
+                day_data[idx].icon_score = score;
+            }
+
+            if (day_count >= max_days && day_data[day_count - 1].has_values && timeinfo.tm_yday > day_data[day_count - 1].yday) {
+                bool all_collected = true;
+                for (int i = 0; i < day_count; ++i) {
+                    if (!day_data[i].has_values) {
+                        all_collected = false;
+                        break;
+                    }
+                }
+                if (all_collected) {
+                    break;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < day_count; ++i) {
+        ForecastEntry &entry = entries[i];
+        copy_text(entry.day, sizeof(entry.day), DAY_NAMES[day_data[i].weekday]);
+        entry.temp_min = day_data[i].has_values ? day_data[i].min_temp : 0.0f;
+        entry.temp_max = day_data[i].has_values ? day_data[i].max_temp : 0.0f;
+        copy_text(entry.icon, sizeof(entry.icon), day_data[i].icon[0] != '\0' ? day_data[i].icon : "01d");
+        entry.valid = day_data[i].has_values;
+    }
+
+    return day_count;
+}
@@ -0,0 +1,363 @@
+#include "weather_ui.h"
+
+#include <time.h>
+
+#include "alloc_trace.h"
+#include "loop_profiler.h"
+#include "weather_images.h"
+
+// UI elements
+static lv_obj_t *temp_label;
+static lv_obj_t *weather_label;
+static lv_obj_t *humidity_label;
+static lv_obj_t *city_label;
+static lv_obj_t *update_label;
+static lv_obj_t *status_label;
+static lv_obj_t *weather_icon;
+static lv_obj_t *forecast_container;
+static lv_obj_t *time_label;
+
+struct ForecastUI {
+    lv_obj_t *day_label;
+    lv_obj_t *icon;
+    lv_obj_t *temp_label;
+};
+
+static ForecastUI forecast_items[FORECAST_DAYS];
+
+struct IconEntry {
+    const char *code;
+    const lv_img_dsc_t *image;
+};
+
+static const IconEntry ICON_MAP[] = {
+    {"01d", &image_weather_icon_01d},
+    {"01n", &image_weather_icon_01n},
+    {"02d", &image_weather_icon_02d},
+    {"02n", &image_weather_icon_02n},
+    {"03d", &image_weather_icon_03d},
+    {"03n", &image_weather_icon_03n},
+    {"04d", &image_weather_icon_04d},
+    {"04n", &image_weather_icon_04n},
+    {"09d", &image_weather_icon_09d},
+    {"09n", &image_weather_icon_09n},
+    {"10d", &image_weather_icon_10d},
+    {"10n", &image_weather_icon_10n},
+    {"11d", &image_weather_icon_11d},
+    {"11n", &image_weather_icon_11n},
+    {"13d", &image_weather_icon_13d},
+    {"13n", &image_weather_icon_13n},
+    {"50d", &image_weather_icon_50d},
+    {"50n", &image_weather_icon_50n},
+};
+
+static const uint16_t WEATHER_ICON_SOURCE_SIZE = 100;
+static const uint16_t FORECAST_ICON_SIZE = 44;
+
+// Transliterate extended Latin characters to ASCII for display
+String transliterate_to_ascii(String str) {
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_TRANSLITERATE);
+    // Serbian/Croatian/Bosnian characters
+    str.replace("š", "s");
+    str.replace("Š", "S");
+    str.replace("č", "c");
+    str.replace("Č", "C");
+    str.replace("ć", "c");
+    str.replace("Ć", "C");
+    str.replace("ž", "z");
+    str.replace("Ž", "Z");
+    str.replace("đ", "d");
+    str.replace("Đ", "D");
+    // German characters
+    str.replace("ü", "u");
+    str.replace("Ü", "U");
+    str.replace("ö", "o");
+    str.replace("Ö", "O");
+    str.replace("ä", "a");
+    str.replace("Ä", "A");
+    str.replace("ß", "ss");
+    // French characters
+    str.replace("é", "e");
+    str.replace("É", "E");
+    str.replace("è", "e");
+    str.replace("È", "E");
+    str.replace("ê", "e");
+    str.replace("Ê", "E");
+    str.replace("à", "a");
+    str.replace("À", "A");
+    str.replace("â", "a");
+    str.replace("Â", "A");
+    str.replace("ô", "o");
+    str.replace("Ô", "O");
+    str.replace("î", "i");
+    str.replace("Î", "I");
+    str.replace("ç", "c");
+    str.replace("Ç", "C");
+    // Spanish characters
+    str.replace("ñ", "n");
+    str.replace("Ñ", "N");
+    str.replace("á", "a");
+    str.replace("Á", "A");
+    str.replace("í", "i");
+    str.replace("Í", "I");
+    str.replace("ó", "o");
+    str.replace("Ó", "O");
+    str.replace("ú", "u");
+    str.replace("Ú", "U");
+    return str;
+}
+
+const lv_img_dsc_t *get_icon_for_code(const char *icon_code) {
+    for (const auto &entry : ICON_MAP) {
+        if (strcmp(icon_code, entry.code) == 0) {
+            return entry.image;
+        }
+    }
+    return &image_weather_icon_01d;
+}
+
+void set_icon_size(lv_obj_t *img_obj, uint16_t size_px) {
+    if (!img_obj || WEATHER_ICON_SOURCE_SIZE == 0) {
+        return;
+    }
+    uint32_t zoom = (static_cast<uint32_t>(size_px) * 256U) / WEATHER_ICON_SOURCE_SIZE;
+    lv_img_set_zoom(img_obj, zoom);
+}
+
+void set_icon_size_with_crop(lv_obj_t *img_obj, uint16_t size_px, float crop_factor) {
+    if (!img_obj || WEATHER_ICON_SOURCE_SIZE == 0) {
+        return;
+    }
+    // Apply crop_factor to zoom in and crop the transparent padding
+    uint32_t zoom = (static_cast<uint32_t>(size_px * crop_factor) * 256U) / WEATHER_ICON_SOURCE_SIZE;
+    lv_img_set_zoom(img_obj, zoom);
+}
+
+void hide_status_message() {
+    if (!status_label) {
+        return;
+    }
+    lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+void show_status_message(const char *message, uint32_t color) {
+    if (!status_label) {
+        return;
+    }
+    lv_label_set_text(status_label, message);
+    lv_obj_set_style_text_color(status_label, lv_color_hex(color), 0);
+    lv_obj_clear_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+void update_forecast_ui(const ForecastEntry *entries) {
+    for (int i = 0; i < FORECAST_DAYS; ++i) {
+        if (!forecast_items[i].day_label) {
+            continue;
+        }
+
+        if (entries[i].valid) {
+            char temp_buffer[16];
+            snprintf(temp_buffer, sizeof(temp_buffer), "%.0f°/%.0f°", entries[i].temp_max, entries[i].temp_min);
+            lv_label_set_text(forecast_items[i].day_label, entries[i].day);
+            lv_label_set_text(forecast_items[i].temp_label, temp_buffer);
+            lv_img_set_src(forecast_items[i].icon, get_icon_for_code(entries[i].icon));
+        } else {
+            lv_label_set_text(forecast_items[i].day_label, "--");
+            lv_label_set_text(forecast_items[i].temp_label, "--°/--°");
+            lv_img_set_src(forecast_items[i].icon, &image_weather_icon_01d);
+        }
+        // set_icon_size_with_crop(forecast_items[i].icon, FORECAST_ICON_SIZE, 1.8);
+
+        set_icon_size(forecast_items[i].icon, FORECAST_ICON_SIZE);
+        lv_obj_set_style_translate_y(forecast_items[i].icon, -15, 0);
+        lv_obj_set_style_translate_y(forecast_items[i].day_label, -38, 0);
+        lv_obj_set_style_translate_y(forecast_items[i].temp_label, -38, 0);
+
+        // lv_obj_set_height(forecast_items[i].icon, FORECAST_ICON_SIZE);
+        // lv_obj_set_style_transform_pivot_y(forecast_items[i].icon, 0, 0);
+    }
+}
+
+void update_time_display(long timezone_offset) {
+    if (!time_label) {
+        return;
+    }
+
+    time_t now_utc = time(nullptr);
+    if (now_utc < 100000) {
+        lv_label_set_text(time_label, "--:--");
+        return;
+    }
+
+    time_t local_time = now_utc + timezone_offset;
+    struct tm timeinfo;
+    if (!gmtime_r(&local_time, &timeinfo)) {
+        lv_label_set_text(time_label, "--:--");
+        return;
+    }
+
+    char time_buffer[32];
+    strftime(time_buffer, sizeof(time_buffer), "%H:%M", &timeinfo);
+    lv_label_set_text(time_label, time_buffer);
+}
+
+// Create UI
+void create_ui() {
+    lv_obj_t *scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x1E1E1E), 0);
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_scrollbar_mode(scr, LV_SCROLLBAR_MODE_OFF);
+
+    status_label = lv_label_create(scr);
+    lv_label_set_text(status_label, "");
+    lv_obj_set_style_text_color(status_label, lv_color_hex(0xFF5555), 0);
+    lv_obj_set_style_text_font(status_label, &lv_font_montserrat_14, 0);
+    lv_obj_align(status_label, LV_ALIGN_TOP_MID, 0, 6);
+    lv_obj_add_flag(status_label, LV_OBJ_FLAG_HIDDEN);
+
+    city_label = lv_label_create(scr);
+    lv_label_set_text(city_label, "Loading...");
+    lv_obj_set_style_text_color(city_label, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_text_font(city_label, &lv_font_montserrat_20, 0);
+    lv_obj_align(city_label, LV_ALIGN_TOP_MID, 0, 16);
+
+    time_label = lv_label_create(scr);
+    lv_label_set_text(time_label, "--:--");
+    lv_obj_set_style_text_color(time_label, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_text_font(time_label, &lv_font_montserrat_28, 0);
+    lv_obj_align(time_label, LV_ALIGN_TOP_MID, 0, 42);
+
+    weather_icon = lv_img_create(scr);
+    lv_img_set_src(weather_icon, &image_weather_icon_01d);
+    lv_obj_align(weather_icon, LV_ALIGN_TOP_MID, 0, 35);
+    set_icon_size(weather_icon, 72);
+
+    temp_label = lv_label_create(scr);
+    lv_label_set_text(temp_label, "--,-°C");
+    lv_obj_set_style_text_color(temp_label, lv_color_hex(0xFFFFFF), 0);
+    lv_obj_set_style_text_font(temp_label, &lv_font_montserrat_36, 0);
+    lv_obj_align_to(temp_label, weather_icon, LV_ALIGN_TOP_MID, 0, 80);
+
+    weather_label = lv_label_create(scr);
+    lv_label_set_text(weather_label, "--------- ------");
+    lv_obj_set_style_text_color(weather_label, lv_color_hex(0xBBBBBB), 0);
+    lv_obj_set_style_text_font(weather_label, &lv_font_montserrat_18, 0);
+    lv_obj_set_style_text_align(weather_label, LV_TEXT_ALIGN_CENTER, 0);
+    lv_obj_set_width(weather_label, 240);
+    lv_obj_align(weather_label, LV_ALIGN_TOP_MID, 0, 152);
+
+    humidity_label = lv_label_create(scr);
+    lv_label_set_text(humidity_label, "Humidity: --%");
+    lv_obj_set_style_text_color(humidity_label, lv_color_hex(0xBBBBBB), 0);
+    lv_obj_set_style_text_font(humidity_label, &lv_font_montserrat_16, 0);
+    lv_obj_align_to(humidity_label, weather_label, LV_ALIGN_OUT_BOTTOM_MID, 0, 8);
+
+    forecast_container = lv_obj_create(scr);
+    lv_obj_set_width(forecast_container, 220);
+    lv_obj_set_height(forecast_container, 90);
+    lv_obj_align(forecast_container, LV_ALIGN_BOTTOM_MID, 0, -5);
+    lv_obj_set_style_bg_color(forecast_container, lv_color_hex(0x2A2A2A), 0);
+    lv_obj_set_style_border_width(forecast_container, 0, 0);
+    lv_obj_set_style_radius(forecast_container, 12, 0);
+    lv_obj_set_style_pad_all(forecast_container, 4, 0);
+    lv_obj_set_style_pad_row(forecast_container, 0, 0);
+    lv_obj_set_style_pad_column(forecast_container, 4, 0);
+    lv_obj_set_flex_flow(forecast_container, LV_FLEX_FLOW_ROW);
+    lv_obj_set_flex_align(forecast_container, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+    lv_obj_clear_flag(forecast_container, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_scroll_dir(forecast_container, LV_DIR_NONE);
+    lv_obj_set_scrollbar_mode(forecast_container, LV_SCROLLBAR_MODE_OFF);
+
+    for (int i = 0; i < FORECAST_DAYS; ++i) {
+        lv_obj_t *item = lv_obj_create(forecast_container);
+        lv_obj_set_width(item, 64);
+        lv_obj_set_height(item, LV_SIZE_CONTENT); // LV_SIZE_CONTENT
+        lv_obj_set_style_bg_color(item, lv_color_hex(0x2A2A2A), 0);
+        lv_obj_set_style_border_width(item, 0, 0);
+        lv_obj_set_style_radius(item, 10, 0);
+        lv_obj_set_style_pad_all(item, 2, 0);
+        lv_obj_set_style_pad_row(item, 0, 0);
+        lv_obj_set_flex_flow(item, LV_FLEX_FLOW_COLUMN);
+        lv_obj_set_flex_align(item, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+        lv_obj_clear_flag(item, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_set_scroll_dir(item, LV_DIR_NONE);
+        lv_obj_set_scrollbar_mode(item, LV_SCROLLBAR_MODE_OFF);
+
+        forecast_items[i].icon = lv_img_create(item);
+        lv_img_set_src(forecast_items[i].icon, &image_weather_icon_01d);
+        set_icon_size(forecast_items[i].icon, FORECAST_ICON_SIZE);
+        lv_obj_set_style_pad_all(forecast_items[i].icon, 0, 0);
+        lv_obj_add_flag(forecast_items[i].icon, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
+        lv_obj_set_style_transform_pivot_y(forecast_items[i].icon, 0, 0);
+        lv_obj_set_style_translate_y(forecast_items[i].icon, -5, 0);
+
+        forecast_items[i].day_label = lv_label_create(item);
+        lv_label_set_text(forecast_items[i].day_label, "---");
+        lv_obj_set_style_text_color(forecast_items[i].day_label, lv_color_hex(0xFFFFFF), 0);
+        lv_obj_set_style_text_font(forecast_items[i].day_label, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_align(forecast_items[i].day_label, LV_TEXT_ALIGN_CENTER, 0);
+        lv_obj_set_style_pad_all(forecast_items[i].day_label, 0, 0);
+        lv_obj_set_style_translate_y(forecast_items[i].day_label, -10, 0);
+
+        forecast_items[i].temp_label = lv_label_create(item);
+        lv_label_set_text(forecast_items[i].temp_label, "--°/--°");
+        lv_obj_set_style_text_color(forecast_items[i].temp_label, lv_color_hex(0xBBBBBB), 0);
+        lv_obj_set_style_text_font(forecast_items[i].temp_label, &lv_font_montserrat_10, 0);
+        lv_obj_set_style_text_align(forecast_items[i].temp_label, LV_TEXT_ALIGN_CENTER, 0);
+        lv_obj_set_style_pad_all(forecast_items[i].temp_label, 0, 0);
+        lv_obj_set_style_translate_y(forecast_items[i].temp_label, -10, 0);
+    }
+
+    update_label = lv_label_create(scr);
+    lv_label_set_text(update_label, "Last update: --:--");
+    lv_obj_set_style_text_color(update_label, lv_color_hex(0x888888), 0);
+    lv_obj_set_style_text_font(update_label, &lv_font_montserrat_10, 0);
+    lv_obj_align_to(update_label, forecast_container, LV_ALIGN_OUT_TOP_MID, 0, -6);
+
+    ForecastEntry placeholders[FORECAST_DAYS];
+    reset_forecast_entries(placeholders, FORECAST_DAYS);
+    update_forecast_ui(placeholders);
+}
+
+// Update weather icon based on OpenWeatherMap icon code
+void update_weather_icon(const char *icon_code) {
+    lv_img_set_src(weather_icon, get_icon_for_code(icon_code));
+}
+
+// Update UI with weather data
+void update_ui(const WeatherData &weather) {
+    ProfileScope profile(STAGE_UPDATE_UI);
+    ALLOC_TRACE_SCOPE(ALLOC_PHASE_UPDATE_UI);
+    char temp_str[32];
+    char humidity_str[32];
+    char update_str[64];
+
+    sprintf(temp_str, "%.1f°C", weather.temperature);
+    lv_label_set_text(temp_label, temp_str);
+
+    // Transliterate city name to ASCII for proper display
+    String displayCity = transliterate_to_ascii(weather.city);
+    lv_label_set_text(city_label, displayCity.c_str());
+
+    // Transliterate weather description to ASCII
+    String desc = transliterate_to_ascii(weather.description);
+    if (desc.length() > 0) {
+        desc[0] = toupper(desc[0]);
+    }
+    lv_label_set_text(weather_label, desc.c_str());
+
+    // Update weather icon
+    update_weather_icon(weather.icon);
+
+    sprintf(humidity_str, "Humidity: %d%%", weather.humidity);
+    lv_label_set_text(humidity_label, humidity_str);
+
+    if (weather.last_update_time[0] != '\0') {
+        snprintf(update_str, sizeof(update_str), "Last update: %s", weather.last_update_time);
+    } else {
+        snprintf(update_str, sizeof(update_str), "Last update: --:--");
+    }
+    lv_label_set_text(update_label, update_str);
+
+    hide_status_message();
+}
@@ -0,0 +1,78 @@
+#include "wifi_cache.h"
+
+#include <Preferences.h>
+
+static const char *NVS_NAMESPACE = "wifi_cache";
+static const char *NVS_KEY = "entry";
+// Bumped when the stored layout changes, so an old entry is ignored
+static const uint8_t STORED_VERSION = 1;
+
+// Plain bytes, as written to NVS
+struct StoredEntry {
+    uint8_t version;
+    char ssid[33];
+    uint8_t bssid[6];
+    int32_t channel;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+
+static bool read_stored(StoredEntry &stored) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+    const bool found = prefs.getBytesLength(NVS_KEY) == sizeof(stored) &&
+                       prefs.getBytes(NVS_KEY, &stored, sizeof(stored)) == sizeof(stored);
+    prefs.end();
+    return found && stored.version == STORED_VERSION;
+}
+
+bool wifi_cache_load(const char *ssid, WifiCacheEntry &entry) {
+    StoredEntry stored;
+    if (!read_stored(stored) || strncmp(stored.ssid, ssid, sizeof(stored.ssid)) != 0 || stored.channel <= 0) {
+        return false;
+    }
+    memcpy(entry.bssid, stored.bssid, sizeof(entry.bssid));
+    entry.channel = stored.channel;
+    entry.ip = IPAddress(stored.ip);
+    entry.gateway = IPAddress(stored.gateway);
+    entry.subnet = IPAddress(stored.subnet);
+    entry.dns = IPAddress(stored.dns);
+    return true;
+}
+
+void wifi_cache_save(const char *ssid, const WifiCacheEntry &entry) {
+    StoredEntry stored;
+    memset(&stored, 0, sizeof(stored));
+    stored.version = STORED_VERSION;
+    strncpy(stored.ssid, ssid, sizeof(stored.ssid) - 1);
+    memcpy(stored.bssid, entry.bssid, sizeof(stored.bssid));
+    stored.channel = entry.channel;
+    stored.ip = entry.ip;
+    stored.gateway = entry.gateway;
+    stored.subnet = entry.subnet;
+    stored.dns = entry.dns;
+
+    // Most boots reconnect to the same access point with the same lease;
+    // skipping those writes spares the flash
+    StoredEntry current;
+    if (read_stored(current) && memcmp(&current, &stored, sizeof(stored)) == 0) {
+        return;
+    }
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.putBytes(NVS_KEY, &stored, sizeof(stored));
+        prefs.end();
+    }
+}
+
+void wifi_cache_clear() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_KEY);
+        prefs.end();
+    }
+}
@@ -0,0 +1,362 @@
+#include "wifi_link.h"
+
+#include <WiFi.h>
+
+#include "wifi_cache.h"
+
+static const UBaseType_t EVENT_QUEUE_LENGTH = 8;
+static const uint32_t STATUS_REPORT_MS = 5000;
+
+enum LinkEventType : uint8_t {
+    LINK_EVENT_GOT_IP,
+    LINK_EVENT_DISCONNECTED,
+    LINK_EVENT_LOST_IP,
+};
+
+struct LinkEvent {
+    LinkEventType type;
+    uint8_t reason;         // disconnect reason (wifi_err_reason_t)
+};
+
+static QueueHandle_t link_events = nullptr;
+static const char *link_ssid = "";
+static const char *link_password = "";
+static bool link_reuse_ip = false;
+
+static WifiLinkState state = WIFI_LINK_IDLE;
+static uint32_t state_since_ms = 0;
+static uint32_t last_report_ms = 0;
+static uint32_t outage_since_ms = 0;    // boot or when the link was lost
+static uint32_t retry_delay_ms = WIFI_LINK_RETRY_MIN_MS;
+static uint32_t wait_ms = 0;
+static bool attempt_cached = false;
+static bool attempt_static_ip = false;
+static bool scan_reported = false;      // the scan runs once per outage
+static uint32_t failed_attempts = 0;    // since the link was last up
+static uint32_t reconnects = 0;
+static uint8_t last_reason = 0;
+
+static const char *STATE_NAMES[] = {
+    "idle",
+    "connecting",
+    "scanning",
+    "waiting to retry",
+    "up",
+};
+
+static const char *wifi_status_to_string(wl_status_t status) {
+    switch (status) {
+        case WL_IDLE_STATUS: return "IDLE";
+        case WL_NO_SSID_AVAIL: return "NO_SSID_AVAILABLE";
+        case WL_SCAN_COMPLETED: return "SCAN_COMPLETED";
+        case WL_CONNECTED: return "CONNECTED";
+        case WL_CONNECT_FAILED: return "CONNECT_FAILED";
+        case WL_CONNECTION_LOST: return "CONNECTION_LOST";
+        case WL_DISCONNECTED: return "DISCONNECTED";
+        default: return "UNKNOWN";
+    }
+}
+
+// Runs on the WiFi event task: only queue the event for wifi_link_poll()
+static void on_wifi_event(arduino_event_id_t event, arduino_event_info_t info) {
+    LinkEvent link_event = {LINK_EVENT_GOT_IP, 0};
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            link_event.type = LINK_EVENT_DISCONNECTED;
+            link_event.reason = info.wifi_sta_disconnected.reason;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            link_event.type = LINK_EVENT_LOST_IP;
+            break;
+        default:
+            return;
+    }
+    xQueueSend(link_events, &link_event, 0);
+}
+
+static void set_state(WifiLinkState new_state, uint32_t now_ms) {
+    state = new_state;
+    state_since_ms = now_ms;
+    last_report_ms = now_ms;
+}
+
+static void discard_events() {
+    LinkEvent event;
+    while (xQueueReceive(link_events, &event, 0) == pdTRUE) {
+    }
+}
+
+// Joins the cached access point when there is one (with its address when
+// reuse_ip is set: no scan and no DHCP), otherwise lets the station pick
+static void start_attempt(uint32_t now_ms, bool use_cache) {
+    WiFi.disconnect();
+    // Whatever is still queued belongs to the previous attempt
+    discard_events();
+
+    WifiCacheEntry cached;
+    attempt_cached = use_cache && wifi_cache_load(link_ssid, cached);
+    attempt_static_ip = attempt_cached && link_reuse_ip && static_cast<uint32_t>(cached.ip) != 0;
+    if (attempt_cached) {
+        Serial.printf("WiFi: connecting to %02X:%02X:%02X:%02X:%02X:%02X on channel %ld (cached)\n",
+                      cached.bssid[0], cached.bssid[1], cached.bssid[2], cached.bssid[3], cached.bssid[4],
+                      cached.bssid[5], (long)cached.channel);
+        if (attempt_static_ip) {
+            WiFi.config(cached.ip, cached.gateway, cached.subnet, cached.dns);
+        }
+        WiFi.begin(link_ssid, link_password, cached.channel, cached.bssid);
+    } else {
+        Serial.printf("WiFi: connecting to '%s'\n", link_ssid);
+        WiFi.begin(link_ssid, link_password);
+    }
+    set_state(WIFI_LINK_CONNECTING, now_ms);
+}
+
+static void wait_for_retry(uint32_t now_ms, uint32_t delay_ms) {
+    wait_ms = delay_ms;
+    set_state(WIFI_LINK_WAITING, now_ms);
+    if (delay_ms > 0) {
+        Serial.printf("WiFi: next attempt in %lu s\n", (unsigned long)(delay_ms / 1000));
+    }
+}
+
+// Waits the backoff delay, which doubles for the next failure
+static void wait_backoff(uint32_t now_ms) {
+    wait_for_retry(now_ms, retry_delay_ms);
+    retry_delay_ms = min(retry_delay_ms * 2, static_cast<uint32_t>(WIFI_LINK_RETRY_MAX_MS));
+}
+
+static void print_possible_issues() {
+    Serial.println("\nPossible issues:");
+    Serial.println("  1. Wrong password in conf.txt");
+    Serial.println("  2. SSID not found (check spelling)");
+    Serial.println("  3. Network is 5GHz (ESP32 only supports 2.4GHz)");
+    Serial.println("  4. Router security settings incompatible");
+    Serial.println("  5. Too far from router (weak signal)");
+    Serial.println("=========================================\n");
+}
+
+static void print_scan_results(int16_t networks_found) {
+    Serial.printf("Found %d networks:\n", networks_found);
+    bool ssid_found = false;
+    for (int i = 0; i < networks_found; i++) {
+        String ssid = WiFi.SSID(i);
+        String encryption = (WiFi.encryptionType(i) == WIFI_AUTH_OPEN) ? "Open" : "Encrypted";
+        Serial.printf("  %d: %s (%d dBm) %s", i + 1, ssid.c_str(), (int)WiFi.RSSI(i), encryption.c_str());
+        if (ssid == link_ssid) {
+            Serial.print(" <- TARGET NETWORK FOUND!");
+            ssid_found = true;
+        }
+        Serial.println();
+    }
+    if (!ssid_found) {
+        Serial.println("\n⚠️  WARNING: Target SSID not found in scan!");
+        Serial.println("    - Check SSID spelling in conf.txt");
+        Serial.println("    - Ensure network is 2.4GHz (ESP32 doesn't support 5GHz)");
+        Serial.println("    - Move closer to the router");
+    }
+    Serial.println("-----------------------------------------");
+}
+
+// Ends the current attempt. A cached access point that does not work any
+// more is dropped and the station gets to pick one right away; a failed full
+// attempt is retried after the backoff delay.
+static WifiLinkChange attempt_failed(uint32_t now_ms, const char *why) {
+    const wl_status_t status = WiFi.status();
+    Serial.printf("WiFi: %s failed after %lu ms (%s)\n", attempt_cached ? "cached access point" : "connection",
+                  (unsigned long)(now_ms - state_since_ms), why);
+    WiFi.disconnect();
+    if (attempt_static_ip) {
+        // Back to DHCP
+        WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    }
+    if (attempt_cached) {
+        wifi_cache_clear();
+        start_attempt(now_ms, false);
+        return WIFI_LINK_NO_CHANGE;
+    }
+
+    ++failed_attempts;
+    if (!scan_reported) {
+        scan_reported = true;
+        Serial.println("=========================================");
+        Serial.println("✗ WiFi connection FAILED!");
+        Serial.println("=========================================");
+        Serial.printf("Final status: %s, last disconnect reason %u\n", wifi_status_to_string(status),
+                      last_reason);
+        print_possible_issues();
+        Serial.println("Scanning for WiFi networks...");
+        if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+            Serial.println("Scan failed to start");
+            wait_backoff(now_ms);
+        } else {
+            set_state(WIFI_LINK_SCANNING, now_ms);
+        }
+    } else {
+        wait_backoff(now_ms);
+    }
+    return WIFI_LINK_FAILED;
+}
+
+static WifiLinkChange link_came_up(uint32_t now_ms) {
+    Serial.println("=========================================");
+    Serial.println("✓ WiFi connected successfully!");
+    Serial.println("=========================================");
+    Serial.printf("Connected in %lu ms (%s)\n", (unsigned long)(now_ms - outage_since_ms),
+                  attempt_cached ? "cached access point" : "scan");
+    Serial.printf("IP address: %s\n", WiFi.localIP().toString().c_str());
+    Serial.printf("Gateway: %s\n", WiFi.gatewayIP().toString().c_str());
+    Serial.printf("Subnet: %s\n", WiFi.subnetMask().toString().c_str());
+    Serial.printf("DNS: %s\n", WiFi.dnsIP().toString().c_str());
+    Serial.printf("Signal strength (RSSI): %d dBm\n", WiFi.RSSI());
+    Serial.printf("Channel: %d\n", WiFi.channel());
+    Serial.println("=========================================\n");
+
+    WifiCacheEntry entry;
+    memcpy(entry.bssid, WiFi.BSSID(), sizeof(entry.bssid));
+    entry.channel = WiFi.channel();
+    entry.ip = WiFi.localIP();
+    entry.gateway = WiFi.gatewayIP();
+    entry.subnet = WiFi.subnetMask();
+    entry.dns = WiFi.dnsIP();
+    wifi_cache_save(link_ssid, entry);
+
+    failed_attempts = 0;
+    retry_delay_ms = WIFI_LINK_RETRY_MIN_MS;
+    scan_reported = false;
+    set_state(WIFI_LINK_UP, now_ms);
+    return WIFI_LINK_CAME_UP;
+}
+
+static WifiLinkChange handle_event(const LinkEvent &event, uint32_t now_ms) {
+    if (event.type == LINK_EVENT_GOT_IP) {
+        return state == WIFI_LINK_CONNECTING ? link_came_up(now_ms) : WIFI_LINK_NO_CHANGE;
+    }
+    if (event.type == LINK_EVENT_DISCONNECTED) {
+        last_reason = event.reason;
+    }
+    if (state == WIFI_LINK_UP) {
+        Serial.printf("WiFi: link lost (%s, reason %u), reconnecting\n",
+                      event.type == LINK_EVENT_LOST_IP ? "address lost" : "disconnected", event.reason);
+        ++reconnects;
+        outage_since_ms = now_ms;
+        // Straight back to the same access point
+        wait_for_retry(now_ms, 0);
+        return WIFI_LINK_WENT_DOWN;
+    }
+    // ASSOC_LEAVE is the station's own disconnect, from starting this attempt
+    if (state == WIFI_LINK_CONNECTING && event.type == LINK_EVENT_DISCONNECTED &&
+        event.reason != WIFI_REASON_ASSOC_LEAVE) {
+        char why[32];
+        snprintf(why, sizeof(why), "disconnect reason %u", event.reason);
+        return attempt_failed(now_ms, why);
+    }
+    return WIFI_LINK_NO_CHANGE;
+}
+
+void wifi_link_begin(const char *ssid, const char *password, bool reuse_ip) {
+    link_ssid = ssid;
+    link_password = password;
+    link_reuse_ip = reuse_ip;
+    if (!link_events) {
+        link_events = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(LinkEvent));
+        WiFi.onEvent(on_wifi_event);
+    }
+
+    Serial.println("\n=========================================");
+    Serial.println("Starting WiFi connection...");
+    Serial.println("=========================================");
+    Serial.printf("SSID: '%s'\n", ssid);
+    Serial.printf("SSID Length: %d characters\n", (int)strlen(ssid));
+    Serial.printf("Password Length: %d characters\n", (int)strlen(password));
+    Serial.println("-----------------------------------------");
+
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);
+    outage_since_ms = millis();
+    start_attempt(outage_since_ms, true);
+}
+
+WifiLinkChange wifi_link_poll(uint32_t now_ms) {
+    if (state == WIFI_LINK_IDLE) {
+        return WIFI_LINK_NO_CHANGE;
+    }
+    // One change per call, so the caller sees every transition
+    LinkEvent event;
+    while (xQueueReceive(link_events, &event, 0) == pdTRUE) {
+        WifiLinkChange change = handle_event(event, now_ms);
+        if (change != WIFI_LINK_NO_CHANGE) {
+            return change;
+        }
+    }
+
+    const uint32_t elapsed_ms = now_ms - state_since_ms;
+    switch (state) {
+        case WIFI_LINK_CONNECTING: {
+            const uint32_t timeout_ms = attempt_cached ? WIFI_LINK_CACHED_TIMEOUT_MS : WIFI_LINK_CONNECT_TIMEOUT_MS;
+            if (elapsed_ms >= timeout_ms) {
+                return attempt_failed(now_ms, wifi_status_to_string(WiFi.status()));
+            }
+            if (now_ms - last_report_ms >= STATUS_REPORT_MS) {
+                Serial.printf("WiFi: status after %lu s: %s\n", (unsigned long)(elapsed_ms / 1000),
+                              wifi_status_to_string(WiFi.status()));
+                last_report_ms = now_ms;
+            }
+            break;
+        }
+        case WIFI_LINK_SCANNING: {
+            const int16_t found = WiFi.scanComplete();
+            if (found == WIFI_SCAN_RUNNING && elapsed_ms < WIFI_LINK_SCAN_TIMEOUT_MS) {
+                break;
+            }
+            if (found >= 0) {
+                print_scan_results(found);
+            } else {
+                Serial.println("Scan failed");
+            }
+            WiFi.scanDelete();
+            wait_backoff(now_ms);
+            break;
+        }
+        case WIFI_LINK_WAITING:
+            if (elapsed_ms >= wait_ms) {
+                start_attempt(now_ms, true);
+            }
+            break;
+        default:
+            break;
+    }
+    return WIFI_LINK_NO_CHANGE;
+}
+
+bool wifi_link_up() {
+    return state == WIFI_LINK_UP;
+}
+
+WifiLinkState wifi_link_state() {
+    return state;
+}
+
+void wifi_link_drop() {
+    Serial.println("WiFi: dropping the link");
+    WiFi.disconnect();
+}
+
+void wifi_link_print(Print &out, uint32_t now_ms) {
+    const uint32_t elapsed_ms = now_ms - state_since_ms;
+    out.println("=========================================");
+    out.println("WiFi link");
+    out.println("=========================================");
+    out.printf("SSID: '%s'\n", link_ssid);
+    out.printf("State: %s for %lu s\n", STATE_NAMES[state], (unsigned long)(elapsed_ms / 1000));
+    if (state == WIFI_LINK_UP) {
+        out.printf("IP address: %s, RSSI %d dBm, channel %d\n", WiFi.localIP().toString().c_str(), WiFi.RSSI(),
+                   WiFi.channel());
+    } else if (state == WIFI_LINK_WAITING) {
+        out.printf("Next attempt in %lu s\n", (unsigned long)((wait_ms - min(elapsed_ms, wait_ms)) / 1000));
+    }
+    out.printf("Failed attempts: %lu, reconnects: %lu, last disconnect reason: %u\n",
+               (unsigned long)failed_attempts, (unsigned long)reconnects, last_reason);
+    out.println("=========================================\n");
+}
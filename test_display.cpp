@@ -1,39 +1,160 @@
-// Simple TFT test to verify display is working
-// Temporarily rename main.cpp and rename this to main.cpp to test
+// Display throughput benchmark
+// Measures how fast pixels reach the ILI9341 over SPI: fillScreen, one
+// setAddrWindow followed by streamed pushColors, and my_disp_flush-style
+// chunked flushes (one setAddrWindow + pushColors per chunk), each with and
+// without byte swapping. Results are printed over Serial in MB/s and fps next
+// to the theoretical bus limit (SPI_FREQUENCY / 8 bytes per second).
+//
+// SPI_FREQUENCY is fixed at compile time by TFT_eSPI, so each frequency has
+// its own environment:
+//   pio run -e display_bench_40mhz -t upload -t monitor
+// Send any character over Serial to run the benchmark again.
 
 #include <TFT_eSPI.h>
 
 TFT_eSPI tft = TFT_eSPI();
 
-void setup() {
-  Serial.begin(115200);
-  Serial.println("TFT Test Starting...");
+static const uint16_t SCREEN_WIDTH = 240;
+static const uint16_t SCREEN_HEIGHT = 320;
+static const uint32_t FRAME_BYTES = (uint32_t)SCREEN_WIDTH * SCREEN_HEIGHT * 2;
+
+// Frames per measurement
+static const int BENCH_FRAMES = 20;
+
+// Chunk heights in lines; 10 matches the LVGL draw buffer in main.cpp
+static const uint16_t CHUNK_LINES[] = {1, 5, 10, 20, 40};
+static const uint16_t MAX_CHUNK_LINES = 40;
+
+static uint16_t *chunk_buffer = nullptr;
 
-  tft.init();
-  tft.setRotation(0);
+struct BenchResult {
+    uint32_t elapsed_us;
+    uint32_t frames;
+};
+
+static BenchResult finish(uint32_t start, uint32_t frames) {
+    uint32_t elapsed = (uint32_t)(micros() - start);
+    return {elapsed > 0 ? elapsed : 1, frames};
+}
+
+static double mbytes_per_sec(const BenchResult &result) {
+    return (double)FRAME_BYTES * result.frames / result.elapsed_us;
+}
 
-  Serial.println("Filling screen red...");
-  tft.fillScreen(TFT_RED);
-  delay(1000);
+static double frames_per_sec(const BenchResult &result) {
+    return result.frames * 1000000.0 / result.elapsed_us;
+}
+
+static double bus_limit_mbytes() {
+    return SPI_FREQUENCY / 8.0 / 1000000.0;
+}
+
+static void print_result(const char *name, const BenchResult &result) {
+    double mbps = mbytes_per_sec(result);
+    Serial.printf("%-28s %8.2f %7.1f %6.1f%%\n", name, mbps, frames_per_sec(result), 100.0 * mbps / bus_limit_mbytes());
+}
+
+// Gradient so both bytes of every pixel change between lines
+static void fill_chunk_buffer(uint16_t lines) {
+    for (uint32_t i = 0; i < (uint32_t)SCREEN_WIDTH * lines; ++i) {
+        chunk_buffer[i] = (uint16_t)(i * 0x0841u);
+    }
+}
 
-  Serial.println("Filling screen green...");
-  tft.fillScreen(TFT_GREEN);
-  delay(1000);
+static BenchResult bench_fill_screen() {
+    static const uint16_t COLORS[] = {TFT_RED, TFT_GREEN, TFT_BLUE, TFT_BLACK};
+    uint32_t start = micros();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        tft.fillScreen(COLORS[frame % 4]);
+    }
+    return finish(start, BENCH_FRAMES);
+}
+
+// One address window for the whole frame, pixels streamed in chunks
+static BenchResult bench_push_colors(uint16_t lines, bool swap) {
+    fill_chunk_buffer(lines);
+    uint32_t start = micros();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        tft.startWrite();
+        tft.setAddrWindow(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+        for (uint16_t y = 0; y < SCREEN_HEIGHT; y += lines) {
+            uint16_t h = min<uint16_t>(lines, SCREEN_HEIGHT - y);
+            tft.pushColors(chunk_buffer, (uint32_t)SCREEN_WIDTH * h, swap);
+        }
+        tft.endWrite();
+    }
+    return finish(start, BENCH_FRAMES);
+}
+
+// Same sequence as my_disp_flush: a transaction and address window per chunk
+static BenchResult bench_chunked_flush(uint16_t lines, bool swap) {
+    fill_chunk_buffer(lines);
+    uint32_t start = micros();
+    for (int frame = 0; frame < BENCH_FRAMES; ++frame) {
+        for (uint16_t y = 0; y < SCREEN_HEIGHT; y += lines) {
+            uint16_t h = min<uint16_t>(lines, SCREEN_HEIGHT - y);
+            tft.startWrite();
+            tft.setAddrWindow(0, y, SCREEN_WIDTH, h);
+            tft.pushColors(chunk_buffer, (uint32_t)SCREEN_WIDTH * h, swap);
+            tft.endWrite();
+        }
+    }
+    return finish(start, BENCH_FRAMES);
+}
+
+void run_display_benchmark() {
+    char name[32];
+
+    Serial.println("=========================================");
+    Serial.printf("Display benchmark @ %.1f MHz SPI\n", SPI_FREQUENCY / 1000000.0);
+    Serial.printf("Bus limit: %.2f MB/s, %.1f fps (%lu bytes/frame)\n", bus_limit_mbytes(),
+                  bus_limit_mbytes() * 1000000.0 / FRAME_BYTES, (unsigned long)FRAME_BYTES);
+    Serial.println("=========================================");
+    Serial.printf("%-28s %8s %7s %7s\n", "test", "MB/s", "fps", "bus");
+
+    print_result("fillScreen", bench_fill_screen());
+
+    for (int swap = 1; swap >= 0; --swap) {
+        for (uint16_t lines : CHUNK_LINES) {
+            snprintf(name, sizeof(name), "pushColors %2u lines%s", lines, swap ? " swap" : "");
+            print_result(name, bench_push_colors(lines, swap));
+        }
+    }
+
+    for (int swap = 1; swap >= 0; --swap) {
+        for (uint16_t lines : CHUNK_LINES) {
+            snprintf(name, sizeof(name), "flush %2u lines%s", lines, swap ? " swap" : "");
+            print_result(name, bench_chunked_flush(lines, swap));
+        }
+    }
+
+    Serial.println("=========================================\n");
+    tft.fillScreen(TFT_BLACK);
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("Display Benchmark Starting...");
 
-  Serial.println("Filling screen blue...");
-  tft.fillScreen(TFT_BLUE);
-  delay(1000);
+    tft.init();
+    tft.setRotation(0);
 
-  Serial.println("Drawing white text...");
-  tft.fillScreen(TFT_BLACK);
-  tft.setTextColor(TFT_WHITE);
-  tft.setTextSize(2);
-  tft.setCursor(10, 10);
-  tft.println("Display Works!");
+    chunk_buffer = (uint16_t *)malloc((size_t)SCREEN_WIDTH * MAX_CHUNK_LINES * sizeof(uint16_t));
+    if (!chunk_buffer) {
+        Serial.println("Failed to allocate chunk buffer");
+        return;
+    }
 
-  Serial.println("Test complete!");
+    run_display_benchmark();
+    Serial.println("Send any character to run again");
 }
 
 void loop() {
-  // Nothing
+    if (chunk_buffer && Serial.available() > 0) {
+        while (Serial.available() > 0) {
+            Serial.read();
+        }
+        run_display_benchmark();
+    }
+    delay(10);
 }
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""Benchmark regression gate for the host benchmarks.
+
+Runs the native_bench program (parse, transliterate and render suites),
+compares every metric with bench/baseline.json and exits with status 1 when
+one got worse by more than its tolerance, when a baseline metric was not
+measured, when a case failed (an "errors" metric above zero) or when the
+baseline is empty. Metrics not in the baseline yet only print a warning.
+All gated metrics are "lower is better": times, bytes, allocations, flushed
+areas and pixels.
+
+Examples:
+    # build, run and compare (same as: pio run -e native_bench -t bench_gate)
+    pio run -e native_bench && tools/bench_gate.py
+
+    # accept the current numbers as the new baseline
+    tools/bench_gate.py --update
+
+    # compare a results file produced elsewhere
+    tools/bench_gate.py --results results.json
+
+Timings depend on the machine, so record the baseline on the machine that
+runs the gate. Tolerances per unit live in the baseline file and can be
+overridden with --tolerance unit=relative[,absolute].
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_BENCH = os.path.join(REPO_ROOT, ".pio", "build", "native_bench", "program")
+DEFAULT_BASELINE = os.path.join(REPO_ROOT, "bench", "baseline.json")
+
+# A metric regresses when new - old > max(old * relative, absolute)
+DEFAULT_TOLERANCES = {
+    "us": {"relative": 0.20, "absolute": 20},
+    "B": {"relative": 0.02, "absolute": 64},
+    "count": {"relative": 0.0, "absolute": 0},
+    "px": {"relative": 0.05, "absolute": 0},
+    "%": {"relative": 0.0, "absolute": 2.0},
+}
+
+# Describe the input rather than the code under test
+INFORMATIONAL_METRICS = {"payload_bytes"}
+
+# Recorded by a suite when a case failed instead of its measurements
+ERROR_METRICS = {"errors"}
+
+
+def metric_key(metric):
+    return "%s/%s/%s" % (metric["suite"], metric["name"], metric["metric"])
+
+
+def load_json(path):
+    with open(path) as f:
+        return json.load(f)
+
+
+def run_bench(bench, iterations, suites):
+    if not os.path.exists(bench):
+        sys.exit("bench_gate: %s not found, build it with: pio run -e native_bench" % bench)
+    fd, results_path = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+    try:
+        command = [bench, "--iterations", str(iterations), "--json", results_path] + suites
+        subprocess.run(command, cwd=REPO_ROOT, check=True)
+        return load_json(results_path)
+    except subprocess.CalledProcessError as error:
+        sys.exit("bench_gate: benchmark failed with status %d" % error.returncode)
+    finally:
+        os.unlink(results_path)
+
+
+def parse_tolerance_overrides(values):
+    overrides = {}
+    for value in values:
+        unit, _, limits = value.partition("=")
+        relative, _, absolute = limits.partition(",")
+        overrides[unit] = {"relative": float(relative), "absolute": float(absolute or 0)}
+    return overrides
+
+
+def compare(baseline, results, tolerances):
+    old = {metric_key(m): m for m in baseline.get("metrics", [])}
+    regressions, improvements, new, errors = [], [], [], []
+    compared = 0
+    seen = set()
+    for metric in results.get("metrics", []):
+        key = metric_key(metric)
+        seen.add(key)
+        if metric["metric"] in ERROR_METRICS:
+            if metric["value"] != 0:
+                errors.append(key)
+            continue
+        if metric["metric"] in INFORMATIONAL_METRICS:
+            continue
+        if key not in old:
+            new.append(metric)
+            continue
+        compared += 1
+        before = old[key]["value"]
+        after = metric["value"]
+        limits = tolerances.get(metric["unit"], {"relative": 0.0, "absolute": 0})
+        allowed = max(abs(before) * limits["relative"], limits["absolute"])
+        if after - before > allowed:
+            regressions.append((key, before, after, metric["unit"], allowed))
+        elif before - after > allowed:
+            improvements.append((key, before, after, metric["unit"], allowed))
+    missing = sorted(key for key in old if key not in seen)
+    return regressions, improvements, new, missing, errors, compared
+
+
+def print_changes(title, changes):
+    if not changes:
+        return
+    print(title)
+    for key, before, after, unit, allowed in changes:
+        delta = (after - before) / before * 100.0 if before else float("inf")
+        print("  %-58s %12.1f -> %12.1f %-5s (%+.1f%%, allowed %.1f)" % (key, before, after, unit, delta, allowed))
+
+
+def write_baseline(path, results, tolerances):
+    baseline = {
+        "tolerances": tolerances,
+        "metrics": results.get("metrics", []),
+    }
+    with open(path, "w") as f:
+        json.dump(baseline, f, indent=2)
+        f.write("\n")
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bench", default=DEFAULT_BENCH, help="native_bench program")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--results", help="compare this results JSON instead of running the benchmark")
+    parser.add_argument("--iterations", type=int, default=200)
+    parser.add_argument("--tolerance", action="append", default=[], metavar="UNIT=REL[,ABS]",
+                        help="override the tolerance for one unit, e.g. us=0.1,10")
+    parser.add_argument("--update", action="store_true", help="write the results as the new baseline")
+    parser.add_argument("suites", nargs="*", help="suites to run (default: all)")
+    return parser.parse_args(argv)
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    results = load_json(args.results) if args.results else run_bench(args.bench, args.iterations, args.suites)
+
+    baseline = load_json(args.baseline) if os.path.exists(args.baseline) else {}
+    tolerances = dict(DEFAULT_TOLERANCES)
+    tolerances.update(baseline.get("tolerances", {}))
+    tolerances.update(parse_tolerance_overrides(args.tolerance))
+
+    if args.update:
+        write_baseline(args.baseline, results, tolerances)
+        print("bench_gate: wrote %d metrics to %s" % (len(results.get("metrics", [])), args.baseline))
+        return 0
+
+    if not baseline.get("metrics"):
+        print("bench_gate: FAILED, %s has no metrics; record it with --update" % args.baseline)
+        return 1
+
+    regressions, improvements, new, missing, errors, compared = compare(baseline, results, tolerances)
+    print()
+    print_changes("Improvements:", improvements)
+    print_changes("Regressions:", regressions)
+    if new:
+        print("Warning: not in baseline (run with --update to record): %d metrics" % len(new))
+    if missing:
+        print("In baseline but not measured:")
+        for key in missing:
+            print("  " + key)
+    if errors:
+        print("Failed cases:")
+        for key in errors:
+            print("  " + key)
+
+    failures = []
+    if regressions:
+        failures.append("%d metric(s) regressed" % len(regressions))
+    if missing:
+        failures.append("%d metric(s) not measured" % len(missing))
+    if errors:
+        failures.append("%d case(s) failed" % len(errors))
+    if failures:
+        print("bench_gate: FAILED, %s" % ", ".join(failures))
+        return 1
+    print("bench_gate: OK (%d compared)" % compared)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+"""Local stand-in for the OpenWeatherMap endpoints used by the firmware.
+
+Serves /data/2.5/weather, /data/2.5/forecast and /data/3.0/onecall from the
+recorded payloads in bench/payloads and can degrade the responses on purpose, so the time
+fetch_weather/fetch_forecast block the UI loop can be measured under bad
+network conditions without touching the real API or its rate limits.
+
+Examples:
+    # plain replay on port 8080
+    tools/mock_owm_server.py
+
+    # 800 ms before the headers, body trickled at 2 KB/s
+    tools/mock_owm_server.py --latency 800 --trickle 2048
+
+    # every third request answers 429, 10 % of the rest answer 5xx
+    tools/mock_owm_server.py --fail-every 3 --fail-status 429 --error-rate 0.1
+
+    # drop keep-alive connections after 5 s idle, like the real API does
+    tools/mock_owm_server.py --idle-timeout 5
+
+    # answer If-None-Match/If-Modified-Since with 304 Not Modified
+    tools/mock_owm_server.py --validators
+
+    # gzip bodies for clients that send Accept-Encoding: gzip
+    tools/mock_owm_server.py --gzip
+
+    # behave like a key without a One Call subscription (401 on /data/3.0)
+    tools/mock_owm_server.py --no-onecall
+
+    # HTTPS on 8443 with a self-signed certificate; the server keeps a
+    # session cache and issues tickets, so clients can resume sessions
+    openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes \
+        -days 365 -subj /CN=localhost -keyout mock.key -out mock.pem
+    tools/mock_owm_server.py --port 8443 --tls-cert mock.pem --tls-key mock.key
+
+Point the native build at it with WS_HTTP_HOST=127.0.0.1:8080, or a device
+with weather_api_host=<workstation-ip>:8080 in conf.txt.
+"""
+
+import argparse
+import email.utils
+import gzip
+import hashlib
+import json
+import os
+import random
+import ssl
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_CORPUS = os.path.join(REPO_ROOT, "bench", "payloads")
+
+ENDPOINTS = {
+    "/data/2.5/weather": "weather",
+    "/data/2.5/forecast": "forecast",
+    "/data/3.0/onecall": "onecall",
+}
+
+
+def etag_for(body):
+    return '"%s"' % hashlib.sha1(body).hexdigest()[:16]
+
+
+class MockState:
+    def __init__(self, args):
+        self.args = args
+        self.lock = threading.Lock()
+        self.request_count = 0
+        self.payloads = {}
+        self.sliced = {}
+        self.last_modified = {}
+        for kind in ("weather", "forecast", "onecall"):
+            path = getattr(args, kind + "_payload")
+            if not os.path.isabs(path):
+                path = os.path.join(args.corpus, path)
+            with open(path, "rb") as f:
+                self.payloads[kind] = f.read()
+            self.last_modified[kind] = int(os.path.getmtime(path))
+
+    def body_for(self, kind, query):
+        """Payload for a request; the forecast honours cnt= and One Call
+        exclude= like the real API."""
+        body = self.payloads[kind]
+        if kind == "onecall":
+            return self.onecall_body(query)
+        if kind != "forecast" or "cnt" not in query:
+            return body
+        try:
+            cnt = int(query["cnt"][0])
+        except ValueError:
+            return body
+        with self.lock:
+            if cnt not in self.sliced:
+                doc = json.loads(body)
+                doc["list"] = doc["list"][:max(cnt, 0)]
+                doc["cnt"] = len(doc["list"])
+                self.sliced[cnt] = json.dumps(doc, separators=(",", ":")).encode("utf-8")
+            return self.sliced[cnt]
+
+    def onecall_body(self, query):
+        body = self.payloads["onecall"]
+        excluded = tuple(sorted(query.get("exclude", [""])[0].split(",")))
+        with self.lock:
+            key = ("onecall",) + excluded
+            if key not in self.sliced:
+                doc = json.loads(body)
+                for part in excluded:
+                    doc.pop(part, None)
+                self.sliced[key] = json.dumps(doc, separators=(",", ":")).encode("utf-8")
+            return self.sliced[key]
+
+    def next_request_number(self):
+        with self.lock:
+            self.request_count += 1
+            return self.request_count
+
+
+class MockHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "MockOWM/1.0"
+
+    def setup(self):
+        # The handshake runs on the connection's thread, not in accept()
+        context = self.server.ssl_context
+        if context is not None:
+            self.request = context.wrap_socket(self.request, server_side=True)
+        super().setup()
+
+    def log_message(self, fmt, *args):
+        if not self.server.state.args.quiet:
+            sys.stderr.write("[mock] " + (fmt % args) + "\n")
+
+    def do_GET(self):
+        state = self.server.state
+        args = state.args
+        number = state.next_request_number()
+        started = time.monotonic()
+
+        url = urlparse(self.path)
+        kind = ENDPOINTS.get(url.path)
+        if kind is None:
+            self.send_json(404, {"cod": "404", "message": "Internal error"})
+            return
+
+        query = parse_qs(url.query)
+        if args.api_key and query.get("appid", [""])[0] != args.api_key:
+            self.send_json(401, {"cod": 401, "message": "Invalid API key."})
+            return
+        if kind == "onecall" and args.no_onecall:
+            self.send_json(401, {"cod": 401, "message": "Please note that using One Call 3.0 requires a separate subscription to the One Call by Call plan."})
+            return
+
+        if args.latency > 0 or args.jitter > 0:
+            time.sleep((args.latency + random.uniform(0, args.jitter)) / 1000.0)
+
+        if args.fail_every and number % args.fail_every == 0:
+            self.send_failure(args.fail_status)
+            return
+        if args.rate_limit_rate and random.random() < args.rate_limit_rate:
+            self.send_failure(429)
+            return
+        if args.error_rate and random.random() < args.error_rate:
+            self.send_failure(random.choice((500, 502, 503)))
+            return
+
+        body = state.body_for(kind, query)
+        if args.validators and self.not_modified(kind, body):
+            self.send_response(304)
+            self.send_validators(kind, body)
+            self.end_headers()
+            if not args.quiet:
+                sys.stderr.write("[mock] #%d %s not modified (connection :%d)\n" % (
+                    number, kind, self.client_address[1]))
+            return
+
+        # Validators stay those of the uncompressed body, so a 304 works
+        # with and without gzip
+        plain = body
+        compressed = args.gzip and self.accepts_gzip()
+        if compressed:
+            body = gzip.compress(body, compresslevel=args.gzip_level, mtime=0)
+
+        truncate = args.truncate_rate and random.random() < args.truncate_rate
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json; charset=utf-8")
+        if args.gzip:
+            self.send_header("Vary", "Accept-Encoding")
+        if compressed:
+            self.send_header("Content-Encoding", "gzip")
+        if args.validators:
+            self.send_validators(kind, plain)
+        if args.chunked:
+            self.send_header("Transfer-Encoding", "chunked")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+        if truncate:
+            self.send_header("Connection", "close")
+            self.close_connection = True
+        self.end_headers()
+
+        if truncate:
+            body = body[: int(len(body) * args.truncate_fraction)]
+        self.write_body(body, args.chunked and not truncate)
+
+        if not args.quiet:
+            sys.stderr.write("[mock] #%d %s %d bytes%s%s in %.0f ms (connection :%d)\n" % (
+                number, kind, len(body), " (gzip of %d)" % len(plain) if compressed else "",
+                " (truncated)" if truncate else "",
+                (time.monotonic() - started) * 1000.0, self.client_address[1]))
+
+    def accepts_gzip(self):
+        # Only the first Accept-Encoding line counts, so a client that sends
+        # a second one instead of replacing HTTPClient's is not served gzip
+        for item in self.headers.get("Accept-Encoding", "").split(","):
+            name, _, params = item.strip().partition(";")
+            if name.strip().lower() != "gzip":
+                continue
+            quality = params.strip()
+            if quality.startswith("q="):
+                try:
+                    return float(quality[2:]) > 0
+                except ValueError:
+                    return False
+            return True
+        return False
+
+    def not_modified(self, kind, body):
+        state = self.server.state
+        if_none_match = self.headers.get("If-None-Match")
+        if if_none_match is not None:
+            return etag_for(body) in [tag.strip() for tag in if_none_match.split(",")]
+        if_modified_since = self.headers.get("If-Modified-Since")
+        if if_modified_since:
+            try:
+                since = email.utils.parsedate_to_datetime(if_modified_since).timestamp()
+            except (TypeError, ValueError):
+                return False
+            return state.last_modified[kind] <= since
+        return False
+
+    def send_validators(self, kind, body):
+        state = self.server.state
+        self.send_header("ETag", etag_for(body))
+        self.send_header("Last-Modified", email.utils.formatdate(state.last_modified[kind], usegmt=True))
+
+    def write_body(self, body, chunked):
+        args = self.server.state.args
+        step = args.chunk_size
+        delay = step / float(args.trickle) if args.trickle > 0 else 0.0
+        try:
+            for offset in range(0, len(body), step):
+                piece = body[offset:offset + step]
+                if chunked:
+                    self.wfile.write(b"%x\r\n%s\r\n" % (len(piece), piece))
+                else:
+                    self.wfile.write(piece)
+                self.wfile.flush()
+                if delay:
+                    time.sleep(delay)
+            if chunked:
+                self.wfile.write(b"0\r\n\r\n")
+        except (BrokenPipeError, ConnectionResetError):
+            self.close_connection = True
+
+    def send_failure(self, status):
+        if status == 429:
+            self.send_json(429, {"cod": 429, "message": "Your account is temporary blocked due to exceeding of requests limitation of your subscription type."},
+                           {"Retry-After": str(self.server.state.args.retry_after)})
+        else:
+            self.send_json(status, {"cod": str(status), "message": "Internal error"})
+
+    def send_json(self, status, obj, headers=None):
+        body = json.dumps(obj).encode("utf-8")
+        self.send_response(status)
+        self.send_header("Content-Type", "application/json; charset=utf-8")
+        self.send_header("Content-Length", str(len(body)))
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", default="0.0.0.0", help="address to bind (default: all interfaces)")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--corpus", default=DEFAULT_CORPUS, help="directory with recorded payloads")
+    parser.add_argument("--weather-payload", default="weather_belgrade_metric.json")
+    parser.add_argument("--forecast-payload", default="forecast_belgrade_metric.json")
+    parser.add_argument("--onecall-payload", default="onecall_belgrade_metric.json")
+    parser.add_argument("--no-onecall", action="store_true", help="answer /data/3.0/onecall with 401")
+    parser.add_argument("--api-key", default="", help="reject requests whose appid differs (401)")
+    parser.add_argument("--latency", type=float, default=0.0, help="delay before the response headers, ms")
+    parser.add_argument("--jitter", type=float, default=0.0, help="random extra latency up to this many ms")
+    parser.add_argument("--trickle", type=int, default=0, help="body throughput limit in bytes/s (0 = unlimited)")
+    parser.add_argument("--chunk-size", type=int, default=512, help="bytes per write when sending the body")
+    parser.add_argument("--chunked", action="store_true", help="use Transfer-Encoding: chunked")
+    parser.add_argument("--truncate-rate", type=float, default=0.0, help="probability of cutting the body short")
+    parser.add_argument("--truncate-fraction", type=float, default=0.5, help="part of the body sent when truncating")
+    parser.add_argument("--fail-every", type=int, default=0, help="every Nth request fails with --fail-status")
+    parser.add_argument("--fail-status", type=int, default=503)
+    parser.add_argument("--rate-limit-rate", type=float, default=0.0, help="probability of a 429 response")
+    parser.add_argument("--error-rate", type=float, default=0.0, help="probability of a 500/502/503 response")
+    parser.add_argument("--retry-after", type=int, default=60, help="Retry-After seconds sent with 429")
+    parser.add_argument("--idle-timeout", type=float, default=0.0,
+                        help="close keep-alive connections idle for this many seconds (0 = never)")
+    parser.add_argument("--validators", action="store_true",
+                        help="send ETag/Last-Modified and answer conditional requests with 304")
+    parser.add_argument("--gzip", action="store_true",
+                        help="gzip the body when the request accepts it (Content-Encoding: gzip)")
+    parser.add_argument("--gzip-level", type=int, default=6, help="compression level for --gzip (1-9)")
+    parser.add_argument("--tls-cert", help="serve HTTPS with this PEM certificate (needs --tls-key)")
+    parser.add_argument("--tls-key", help="PEM private key of --tls-cert")
+    parser.add_argument("--seed", type=int, default=None, help="random seed for reproducible fault sequences")
+    parser.add_argument("--quiet", action="store_true")
+    args = parser.parse_args(argv)
+    args.chunk_size = max(1, args.chunk_size)
+    return args
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    if args.seed is not None:
+        random.seed(args.seed)
+    if args.idle_timeout > 0:
+        MockHandler.timeout = args.idle_timeout
+    server = ThreadingHTTPServer((args.host, args.port), MockHandler)
+    server.daemon_threads = True
+    server.state = MockState(args)
+    server.ssl_context = None
+    if args.tls_cert:
+        server.ssl_context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        server.ssl_context.load_cert_chain(args.tls_cert, args.tls_key)
+    sys.stderr.write("[mock] serving OpenWeatherMap stand-in on %s:%d%s\n"
+                     % (args.host, args.port, " (HTTPS)" if server.ssl_context else ""))
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+
+
+if __name__ == "__main__":
+    main()
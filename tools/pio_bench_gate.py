@@ -0,0 +1,12 @@
+# PlatformIO extra script for native_bench: adds the bench_gate target, which
+# builds the benchmark program and runs tools/bench_gate.py against it.
+#   pio run -e native_bench -t bench_gate
+Import("env")
+
+env.AddCustomTarget(
+    name="bench_gate",
+    dependencies="$BUILD_DIR/${PROGNAME}",
+    actions="$PYTHONEXE tools/bench_gate.py --bench $BUILD_DIR/${PROGNAME}",
+    title="Benchmark gate",
+    description="Run the host benchmarks and compare them with bench/baseline.json",
+)